@@ -1196,11 +1196,12 @@ int main(int argc, char *argv[])
     std::unordered_map<uint32_t, std::vector<std::string>> hashedDictionary_Cyclic8;
 
     auto spellChecker = somera::SpellCheckerFactory::Create();
+    auto spellChecker_SymmetricDelete = somera::SpellCheckerFactory::Create(
+        somera::SpellCheckerEngine::SymmetricDelete);
     SpellChecker_Ngram spellChecker_Ngram;
 
     ReadDictionaryFile(dictionarySourcePath, [&](const std::string& word) {
         dictionary.push_back(word);
-        spellChecker->AddWord(word);
         spellChecker_Ngram.AddWord(word);
         
         {
@@ -1302,6 +1303,8 @@ int main(int argc, char *argv[])
             iter->second.push_back(word);
         }
     });
+    spellChecker->AddWords(dictionary);
+    spellChecker_SymmetricDelete->AddWords(dictionary);
 
 //    {
 //        double ave = 0.0;
@@ -1528,5 +1531,14 @@ int main(int argc, char *argv[])
         }
     });
 
+    std::cout << "------------------" << std::endl;
+
+    std::cout << "spellChecker_SymmetricDelete" << std::endl;
+    measurePerformanceTime([&] {
+        for (auto & word : inputWords) {
+            Print(*spellChecker_SymmetricDelete, word);
+        }
+    });
+
     return 0;
 }
@@ -100,9 +100,10 @@ int main(int argc, char *argv[])
         if (p.tag != PartOfSpeechTag::Word) {
             return;
         }
-        auto iter = wordFrequencies.find(p.text);
+        auto word = p.text.toString();
+        auto iter = wordFrequencies.find(word);
         if (iter == std::end(wordFrequencies)) {
-            wordFrequencies.emplace(p.text, 1);
+            wordFrequencies.emplace(std::move(word), 1);
         }
         else {
             ++iter->second;
@@ -0,0 +1,48 @@
+// Copyright (c) 2015 mogemimi. Distributed under the MIT license.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace somera {
+
+///@brief Calls `function(worker, index)` for each index in [0, count) on up
+/// to `threadCount` threads, where `worker` is the index of the thread.
+///
+/// The threads take the next index as they finish the previous one, so
+/// the indices need not take the same time. To keep contiguous ranges on
+/// one thread, split [0, count) into `threadCount` parts and pass the parts.
+template <class Function>
+void ParallelFor(int threadCount, std::size_t count, Function function)
+{
+    const auto workerCount = static_cast<int>(std::min<std::size_t>(
+        static_cast<std::size_t>(std::max(threadCount, 1)), std::max<std::size_t>(count, 1)));
+    std::atomic<std::size_t> nextIndex(0);
+    auto worker = [&](int workerIndex) {
+        for (;;) {
+            const auto index = nextIndex++;
+            if (index >= count) {
+                break;
+            }
+            function(workerIndex, index);
+        }
+    };
+    if (workerCount == 1) {
+        worker(0);
+        return;
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(workerCount);
+    for (int i = 0; i < workerCount; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+}
+
+} // namespace somera
@@ -0,0 +1,98 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace somera {
+
+class StringView final {
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+
+public:
+    constexpr StringView() noexcept = default;
+
+    constexpr StringView(const char* s, std::size_t length) noexcept
+        : data_(s)
+        , size_(length)
+    {}
+
+    StringView(const char* s) noexcept
+        : data_(s)
+        , size_(std::strlen(s))
+    {}
+
+    StringView(const std::string& s) noexcept
+        : data_(s.data())
+        , size_(s.size())
+    {}
+
+    constexpr const char* data() const noexcept
+    {
+        return data_;
+    }
+
+    constexpr std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    constexpr bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    constexpr const char* begin() const noexcept
+    {
+        return data_;
+    }
+
+    constexpr const char* end() const noexcept
+    {
+        return data_ + size_;
+    }
+
+    char operator[](std::size_t index) const
+    {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    StringView substr(std::size_t offset, std::size_t count) const
+    {
+        assert(offset <= size_);
+        return StringView(data_ + offset, std::min(count, size_ - offset));
+    }
+
+    std::string toString() const
+    {
+        return std::string(data_, size_);
+    }
+};
+
+inline bool operator==(const StringView& a, const StringView& b) noexcept
+{
+    return (a.size() == b.size())
+        && ((a.size() == 0) || (std::memcmp(a.data(), b.data(), a.size()) == 0));
+}
+
+inline bool operator!=(const StringView& a, const StringView& b) noexcept
+{
+    return !(a == b);
+}
+
+///@brief Compares the same way as `std::string`.
+inline bool operator<(const StringView& a, const StringView& b) noexcept
+{
+    const auto length = std::min(a.size(), b.size());
+    const auto result = (length == 0) ? 0 : std::memcmp(a.data(), b.data(), length);
+    return (result != 0) ? (result < 0) : (a.size() < b.size());
+}
+
+} // namespace somera
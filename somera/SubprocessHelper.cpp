@@ -2,6 +2,7 @@
 
 #include "SubprocessHelper.h"
 #include <cassert>
+#include <cerrno>
 #include <cstdio>
 #include <utility>
 
@@ -45,11 +46,16 @@ SubprocessHelper::call(const std::string& command)
     while (::fgets(buffer, maxBufferSize, stream) != nullptr) {
         output.append(buffer);
     }
-    if (closeProcess(stream) != 0) {
-        // error: Failed to call popen()
+    const auto status = closeProcess(stream);
+    if (status == -1) {
+        // error: Failed to call pclose()
         std::error_code err {errno, std::generic_category()};
         return std::make_tuple(std::move(output), std::move(err));
     }
+    if (status != 0) {
+        // error: The command exited with a non-zero status, which doesn't set errno.
+        return std::make_tuple(std::move(output), std::make_error_code(std::errc::io_error));
+    }
     return std::make_tuple(std::move(output), std::error_code{});
 }
 
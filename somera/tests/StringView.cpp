@@ -0,0 +1,61 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#include "StringView.h"
+#include <gtest/iutest_switch.hpp>
+
+using namespace somera;
+
+TEST(StringView, Construct)
+{
+    {
+        StringView view;
+        EXPECT_TRUE(view.empty());
+        EXPECT_EQ(0, view.size());
+    }
+    {
+        StringView view("baka and test");
+        EXPECT_FALSE(view.empty());
+        EXPECT_EQ(13, view.size());
+        EXPECT_EQ("baka and test", view.toString());
+    }
+    {
+        std::string s = "baka";
+        StringView view(s);
+        EXPECT_EQ(s.data(), view.data());
+        EXPECT_EQ(4, view.size());
+    }
+    {
+        StringView view("baka and test", 4);
+        EXPECT_EQ("baka", view.toString());
+    }
+}
+
+TEST(StringView, Substr)
+{
+    StringView view("baka and test");
+    EXPECT_EQ("baka", view.substr(0, 4).toString());
+    EXPECT_EQ("and", view.substr(5, 3).toString());
+    EXPECT_EQ("test", view.substr(9, 100).toString());
+    EXPECT_TRUE(view.substr(13, 1).empty());
+}
+
+TEST(StringView, Equal)
+{
+    EXPECT_TRUE(StringView("") == StringView());
+    EXPECT_TRUE(StringView("baka") == StringView("baka and test", 4));
+    EXPECT_TRUE(StringView("baka") == std::string("baka"));
+    EXPECT_FALSE(StringView("baka") == StringView("bak"));
+    EXPECT_FALSE(StringView("baka") == StringView("test"));
+    EXPECT_TRUE(StringView("baka") != StringView("test"));
+}
+
+TEST(StringView, Less)
+{
+    EXPECT_TRUE(StringView("") < StringView("a"));
+    EXPECT_TRUE(StringView("bak") < StringView("baka"));
+    EXPECT_TRUE(StringView("Baka") < StringView("baka"));
+    EXPECT_TRUE(StringView("baka") < StringView("test"));
+    EXPECT_FALSE(StringView("baka") < StringView("baka"));
+    EXPECT_FALSE(StringView("test") < StringView("baka"));
+    EXPECT_TRUE(StringView("a") < StringView("\xE3\x80\x80"));
+}
@@ -0,0 +1,364 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#include "SpellChecker.h"
+#include "TextReader.h"
+#include "somera/CommandLineParser.h"
+#include "somera/StringHelper.h"
+#include <sys/resource.h>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using somera::CommandLineParser;
+
+namespace {
+
+struct Query {
+    std::string input;
+    std::string expected;
+};
+
+struct QuerySetReport {
+    std::string name;
+    std::size_t queryCount = 0;
+    std::size_t hitCountAt1 = 0;
+    std::size_t hitCountAt4 = 0;
+    double seconds = 0;
+    std::vector<double> latencies;
+};
+
+std::error_code ReadWords(const std::string& path, std::vector<std::string> & words)
+{
+    somera::TextPosition errorPosition;
+    return somera::ReadWordsFromTextFile(path, [&](const somera::WordView& word) {
+        words.push_back(word.text.toString());
+    }, errorPosition);
+}
+
+///@brief Reads the "correction < misspelled" lines of MisspelledWords.txt.
+std::vector<Query> ReadMisspelledWords(const std::string& path)
+{
+    std::vector<Query> queries;
+    std::ifstream input(path, std::ios::binary);
+    std::string line;
+    while (std::getline(input, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        auto pair = somera::StringHelper::split(line, " < ");
+        if (pair.size() != 2) {
+            continue;
+        }
+        queries.push_back(Query{pair.back(), pair.front()});
+    }
+    return queries;
+}
+
+///@brief Applies `editCount` random deletions, insertions and swaps,
+/// the same edits as RandomEditWord in approximate-winter.
+std::string RandomEditWord(const std::string& input, int editCount, std::mt19937 & random)
+{
+    std::string word = input;
+    std::uniform_int_distribution<int> letterDist('a', 'z');
+
+    for (; editCount > 0; --editCount) {
+        if (word.size() <= 1) {
+            word.push_back(static_cast<char>(letterDist(random)));
+            continue;
+        }
+
+        std::uniform_int_distribution<std::size_t> positionDist(0, word.size() - 1);
+        std::uniform_int_distribution<int> operationDist(0, 2);
+        const auto operation = operationDist(random);
+
+        if (operation == 0) {
+            word.erase(positionDist(random), 1);
+        }
+        else if (operation == 1) {
+            word.insert(positionDist(random), 1, static_cast<char>(letterDist(random)));
+        }
+        else {
+            // NOTE: Swapping a letter with itself or with an equal letter
+            // changes nothing, so it doesn't count as an edit.
+            auto a = positionDist(random);
+            auto b = positionDist(random);
+            if (word[a] == word[b]) {
+                ++editCount;
+                continue;
+            }
+            std::swap(word[a], word[b]);
+        }
+    }
+    return word;
+}
+
+std::vector<Query> MakeSyntheticQueries(
+    std::vector<std::string> words,
+    std::size_t queryCount,
+    int maxEditCount,
+    unsigned int seed)
+{
+    const std::unordered_set<std::string> dictionary(std::begin(words), std::end(words));
+
+    std::mt19937 random(seed);
+    std::shuffle(std::begin(words), std::end(words), random);
+    std::uniform_int_distribution<int> editDist(1, std::max(maxEditCount, 1));
+
+    // NOTE:
+    // The edits can cancel each other out or turn the word into another
+    // dictionary word, such as "form" into "from". Such an input isn't a
+    // misspelling, so it is edited again, and the word is skipped if that
+    // keeps happening.
+    constexpr int maxAttemptCount = 16;
+
+    std::vector<Query> queries;
+    for (std::size_t i = 0; (i < words.size()) && (queries.size() < queryCount); ++i) {
+        for (int attempt = 0; attempt < maxAttemptCount; ++attempt) {
+            auto input = RandomEditWord(words[i], editDist(random), random);
+            if ((input != words[i]) && (dictionary.count(input) == 0)) {
+                queries.push_back(Query{std::move(input), words[i]});
+                break;
+            }
+        }
+    }
+    return queries;
+}
+
+QuerySetReport RunQueries(
+    const std::string& name,
+    const std::vector<Query>& queries,
+    somera::SpellChecker & spellChecker)
+{
+    using Clock = std::chrono::steady_clock;
+
+    QuerySetReport report;
+    report.name = name;
+    report.queryCount = queries.size();
+    report.latencies.reserve(queries.size());
+
+    const auto start = Clock::now();
+    for (auto & query : queries) {
+        const auto queryStart = Clock::now();
+        const auto result = spellChecker.Suggest(query.input);
+        const auto queryEnd = Clock::now();
+        report.latencies.push_back(std::chrono::duration<double, std::micro>(queryEnd - queryStart).count());
+
+        // NOTE: A correctly spelled input is a hit only if it is the expected word.
+        if (result.correctlySpelled && (query.input == query.expected)) {
+            ++report.hitCountAt1;
+            ++report.hitCountAt4;
+            continue;
+        }
+        const auto & suggestions = result.suggestions;
+        const auto found = std::find(std::begin(suggestions), std::end(suggestions), query.expected);
+        const auto rank = std::distance(std::begin(suggestions), found);
+        if (found == std::end(suggestions)) {
+            continue;
+        }
+        if (rank < 1) {
+            ++report.hitCountAt1;
+        }
+        if (rank < 4) {
+            ++report.hitCountAt4;
+        }
+    }
+    report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return report;
+}
+
+double Percentile(const std::vector<double>& sortedValues, double percentile)
+{
+    if (sortedValues.empty()) {
+        return 0;
+    }
+    // NOTE: Nearest-rank method
+    const auto rank = static_cast<std::size_t>(std::ceil(percentile / 100.0 * sortedValues.size()));
+    return sortedValues[std::max<std::size_t>(rank, 1) - 1];
+}
+
+long GetPeakResidentSetSize()
+{
+    struct rusage usage;
+    if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__) && defined(__MACH__)
+    return usage.ru_maxrss;
+#else
+    // NOTE: Linux reports ru_maxrss in kilobytes.
+    return usage.ru_maxrss * 1024L;
+#endif
+}
+
+std::string EscapeJsonString(const std::string& text)
+{
+    std::string result;
+    for (auto c : text) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned char>(c));
+            result += buffer;
+        }
+        else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+void WriteReport(
+    std::FILE* output,
+    const std::string& engineName,
+    const std::string& dictionaryPath,
+    std::size_t dictionaryWordCount,
+    double loadSeconds,
+    std::vector<QuerySetReport> & reports)
+{
+    std::fprintf(output, "{\n");
+    std::fprintf(output, "  \"engine\": \"%s\",\n", EscapeJsonString(engineName).c_str());
+    std::fprintf(output, "  \"dictionary\": {\"path\": \"%s\", \"words\": %zu, \"load_seconds\": %.6f},\n",
+        EscapeJsonString(dictionaryPath).c_str(), dictionaryWordCount, loadSeconds);
+    std::fprintf(output, "  \"peak_rss_bytes\": %ld,\n", GetPeakResidentSetSize());
+    std::fprintf(output, "  \"sets\": [\n");
+    for (std::size_t i = 0; i < reports.size(); ++i) {
+        auto & report = reports[i];
+        auto & latencies = report.latencies;
+        std::sort(std::begin(latencies), std::end(latencies));
+
+        const auto count = static_cast<double>(std::max<std::size_t>(report.queryCount, 1));
+        double sum = 0;
+        for (auto latency : latencies) {
+            sum += latency;
+        }
+        std::fprintf(output, "    {\n");
+        std::fprintf(output, "      \"name\": \"%s\",\n", EscapeJsonString(report.name).c_str());
+        std::fprintf(output, "      \"queries\": %zu,\n", report.queryCount);
+        std::fprintf(output, "      \"recall_at_1\": %.4f,\n", report.hitCountAt1 / count);
+        std::fprintf(output, "      \"recall_at_4\": %.4f,\n", report.hitCountAt4 / count);
+        std::fprintf(output, "      \"latency_us\": {\"mean\": %.3f, \"p50\": %.3f, \"p99\": %.3f, \"max\": %.3f},\n",
+            sum / count,
+            Percentile(latencies, 50),
+            Percentile(latencies, 99),
+            latencies.empty() ? 0.0 : latencies.back());
+        std::fprintf(output, "      \"throughput_qps\": %.1f\n",
+            (report.seconds > 0) ? (report.queryCount / report.seconds) : 0.0);
+        std::fprintf(output, "    }%s\n", (i + 1 < reports.size()) ? "," : "");
+    }
+    std::fprintf(output, "  ]\n");
+    std::fprintf(output, "}\n");
+}
+
+} // unnamed namespace
+
+int main(int argc, char *argv[])
+{
+    CommandLineParser parser;
+    using Type = somera::CommandLineArgumentType;
+    parser.setUsageText("spell-checker-bench [options ...]");
+    parser.addArgument("-h", Type::Flag, "Display available options");
+    parser.addArgument("-dict", Type::JoinedOrSeparate, "Dictionary file (default: ../approximate-winter/SINGLE.TXT)");
+    parser.addArgument("-misspelled", Type::JoinedOrSeparate, "Misspelled word list (default: ../approximate-winter/MisspelledWords.txt)");
+    parser.addArgument("-engine", Type::JoinedOrSeparate, "Spell checker engine (signature, symspell or dawg)");
+    parser.addArgument("-synthetic", Type::JoinedOrSeparate, "Number of synthetic misspellings (default: 2000)");
+    parser.addArgument("-max-edits", Type::JoinedOrSeparate, "Maximum number of edits per synthetic misspelling (default: 2)");
+    parser.addArgument("-seed", Type::JoinedOrSeparate, "Random seed of the synthetic misspellings (default: 10000)");
+    parser.addArgument("-o", Type::JoinedOrSeparate, "Write the JSON report to the file instead of stdout");
+    parser.parse(argc, argv);
+
+    if (parser.hasParseError()) {
+        std::cerr << parser.getErrorMessage() << std::endl;
+        return 1;
+    }
+    if (parser.exists("-h")) {
+        std::cout << parser.getHelpText() << std::endl;
+        return 0;
+    }
+
+    std::string dictionaryPath = "../approximate-winter/SINGLE.TXT";
+    std::string misspelledPath = "../approximate-winter/MisspelledWords.txt";
+    std::string engineName = "signature";
+    std::size_t syntheticCount = 2000;
+    int maxEditCount = 2;
+    unsigned int seed = 10000;
+    if (auto path = parser.getValue("-dict")) {
+        dictionaryPath = *path;
+    }
+    if (auto path = parser.getValue("-misspelled")) {
+        misspelledPath = *path;
+    }
+    if (auto name = parser.getValue("-engine")) {
+        engineName = *name;
+    }
+    if (auto count = parser.getValue("-synthetic")) {
+        syntheticCount = static_cast<std::size_t>(std::max(std::atoi(count->c_str()), 0));
+    }
+    if (auto count = parser.getValue("-max-edits")) {
+        maxEditCount = std::atoi(count->c_str());
+    }
+    if (auto value = parser.getValue("-seed")) {
+        seed = static_cast<unsigned int>(std::strtoul(value->c_str(), nullptr, 10));
+    }
+
+    auto engine = somera::SpellCheckerEngine::SignatureHashing;
+    if (engineName == "symspell") {
+        engine = somera::SpellCheckerEngine::SymmetricDelete;
+    }
+    else if (engineName == "dawg") {
+        engine = somera::SpellCheckerEngine::Dawg;
+    }
+    else if (engineName != "signature") {
+        std::cerr << "error: unknown engine " << engineName << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> words;
+    if (auto errorCode = ReadWords(dictionaryPath, words)) {
+        std::cerr << "error: " << errorCode.message() << ", " << dictionaryPath << std::endl;
+        return 1;
+    }
+
+    const auto loadStart = std::chrono::steady_clock::now();
+    auto spellChecker = somera::SpellCheckerFactory::Create(engine);
+    spellChecker->AddWords(words);
+    const auto loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+
+    std::vector<QuerySetReport> reports;
+    const auto misspelledQueries = ReadMisspelledWords(misspelledPath);
+    if (misspelledQueries.empty()) {
+        std::cerr << "warning: no misspelled words in " << misspelledPath << std::endl;
+    }
+    else {
+        reports.push_back(RunQueries("misspelled", misspelledQueries, *spellChecker));
+    }
+    if (syntheticCount > 0) {
+        const auto syntheticQueries = MakeSyntheticQueries(words, syntheticCount, maxEditCount, seed);
+        reports.push_back(RunQueries("synthetic", syntheticQueries, *spellChecker));
+    }
+
+    std::FILE* output = stdout;
+    if (auto path = parser.getValue("-o")) {
+        output = std::fopen(path->c_str(), "w");
+        if (output == nullptr) {
+            std::cerr << "error: cannot open " << *path << std::endl;
+            return 1;
+        }
+    }
+    WriteReport(output, engineName, dictionaryPath, words.size(), loadSeconds, reports);
+    if (output != stdout) {
+        std::fclose(output);
+    }
+    return 0;
+}
@@ -0,0 +1,263 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#include "WordSegmenter.h"
+#include "somera/CommandLineParser.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <regex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using somera::CommandLineParser;
+using somera::PartOfSpeech;
+using somera::PartOfSpeechTag;
+
+namespace {
+
+// NOTE:
+// The regex-based segmenter that WordSegmenter replaced, kept as the
+// baseline for the "before" numbers and as the reference for the tokens.
+namespace Legacy {
+
+struct Token {
+    std::string text;
+    PartOfSpeechTag tag;
+};
+
+bool IsSeparator(char32_t c)
+{
+    std::string separators = "!\"#$%&()*+,./:;<=>?@[\\]^`{|}~";
+    assert(std::is_sorted(separators.begin(), separators.end()));
+    return std::binary_search(std::begin(separators), std::end(separators), c);
+}
+
+bool IsConcatenator(char32_t c)
+{
+    std::string separators = "'-";
+    assert(std::is_sorted(separators.begin(), separators.end()));
+    return std::binary_search(std::begin(separators), std::end(separators), c);
+}
+
+std::vector<std::tuple<std::string, PartOfSpeechTag>> SplitBySpace(const std::string& str)
+{
+    std::vector<std::tuple<std::string, PartOfSpeechTag>> tokens;
+    std::string buffer;
+    std::string separator;
+    auto flushBuffer = [&] {
+        if (!buffer.empty()) {
+            tokens.emplace_back(buffer, PartOfSpeechTag::Word);
+            buffer.clear();
+        }
+    };
+    auto flushSeparator = [&] {
+        if (!separator.empty()) {
+            tokens.emplace_back(separator, PartOfSpeechTag::Spaces);
+            separator.clear();
+        }
+    };
+    for (auto character : str) {
+        if (::isspace(static_cast<unsigned char>(character))) {
+            flushBuffer();
+            separator += character;
+        }
+        else {
+            flushSeparator();
+            buffer += character;
+        }
+    }
+    flushBuffer();
+    flushSeparator();
+    return tokens;
+}
+
+void TokenizeByAsciiSymbols(
+    const std::string& str,
+    std::function<void(const Token&)> callback)
+{
+    std::string buffer;
+    std::string separator;
+
+    auto flushBuffer = [&] {
+        if (buffer.empty()) {
+            return;
+        }
+        auto trimRight = std::find_if(std::rbegin(buffer), std::rend(buffer),
+            [&](char32_t c){ return !IsConcatenator(c); }).base();
+
+        std::string prefix(std::begin(buffer), trimRight);
+        std::string suffix(trimRight, std::end(buffer));
+        buffer.clear();
+
+        if (std::regex_match(prefix, std::regex(R"(\d+)"))) {
+            callback({prefix, PartOfSpeechTag::Integer});
+        }
+        else if (std::regex_match(prefix, std::regex(R"(0x[\dA-Fa-f]+)"))) {
+            callback({prefix, PartOfSpeechTag::IntegerHex});
+        }
+        else if (std::regex_match(prefix, std::regex(R"(0b[01]+)"))) {
+            callback({prefix, PartOfSpeechTag::IntegerBinary});
+        }
+        else if (std::regex_match(prefix, std::regex(R"((\d*\.\d+|\d+\.\d*)f?)"))) {
+            callback({prefix, PartOfSpeechTag::FloatNumber});
+        }
+        else {
+            callback({prefix, PartOfSpeechTag::Word});
+        }
+        if (!suffix.empty()) {
+            callback({suffix, PartOfSpeechTag::Symbol});
+        }
+    };
+    auto flushSeparator = [&] {
+        if (!separator.empty()) {
+            callback({separator, PartOfSpeechTag::Spaces});
+            separator.clear();
+        }
+    };
+    for (auto character : str) {
+        if ((IsSeparator(character)) || (buffer.empty() && IsConcatenator(character))) {
+            flushBuffer();
+            separator += character;
+        }
+        else {
+            flushSeparator();
+            buffer += character;
+        }
+    }
+    flushBuffer();
+    flushSeparator();
+}
+
+void Parse(const std::string& str, std::function<void(const Token&)> callback)
+{
+    for (auto & tuple : SplitBySpace(str)) {
+        auto & text = std::get<0>(tuple);
+        auto & tag = std::get<1>(tuple);
+        if (tag == PartOfSpeechTag::Spaces) {
+            callback({text, PartOfSpeechTag::Spaces});
+            continue;
+        }
+        if (std::regex_match(text, std::regex(R"(git@\w+\..+)"))) {
+            callback({text, PartOfSpeechTag::GitUrl});
+            continue;
+        }
+        if (std::regex_match(text, std::regex(R"((http|https|ftp)://.+)"))) {
+            callback({text, PartOfSpeechTag::Url});
+            continue;
+        }
+        TokenizeByAsciiSymbols(text, callback);
+    }
+}
+
+} // namespace Legacy
+
+std::string ReadFile(const std::string& path)
+{
+    std::ifstream input(path, std::ios::binary);
+    return std::string(
+        std::istreambuf_iterator<char>(input),
+        std::istreambuf_iterator<char>());
+}
+
+template <class Function>
+double MeasureSeconds(Function f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+} // unnamed namespace
+
+int main(int argc, char *argv[])
+{
+    CommandLineParser parser;
+    using Type = somera::CommandLineArgumentType;
+    parser.setUsageText("word-segmenter-bench [options ...] [file ...]");
+    parser.addArgument("-h", Type::Flag, "Display available options");
+    parser.addArgument("-no-legacy", Type::Flag, "Skip the regex-based segmenter");
+    parser.parse(argc, argv);
+
+    if (parser.hasParseError()) {
+        std::cerr << parser.getErrorMessage() << std::endl;
+        return 1;
+    }
+    if (parser.exists("-h") || parser.getPaths().empty()) {
+        std::cout << parser.getHelpText() << std::endl;
+        return 0;
+    }
+
+    std::vector<std::string> texts;
+    std::size_t byteCount = 0;
+    for (auto & path : parser.getPaths()) {
+        texts.push_back(ReadFile(path));
+        byteCount += texts.back().size();
+    }
+
+    // NOTE: Lines are the unit that typo-poi passes to the segmenter.
+    std::vector<std::string> lines;
+    for (auto & text : texts) {
+        std::string::size_type first = 0;
+        while (first < text.size()) {
+            auto last = std::min(text.find('\n', first), text.size());
+            lines.push_back(text.substr(first, last - first));
+            first = last + 1;
+        }
+    }
+
+    std::size_t tokenCount = 0;
+    somera::WordSegmenter segmenter;
+    const auto seconds = MeasureSeconds([&] {
+        for (auto & line : lines) {
+            segmenter.Parse(line, [&](const PartOfSpeech&) {
+                ++tokenCount;
+            });
+        }
+    });
+
+    std::printf("files:  %zu (%zu bytes, %zu lines)\n", texts.size(), byteCount, lines.size());
+    std::printf("WordSegmenter: %zu tokens, %.3f s, %.0f tokens/s\n",
+        tokenCount, seconds, tokenCount / seconds);
+
+    if (parser.exists("-no-legacy")) {
+        return 0;
+    }
+
+    std::vector<Legacy::Token> legacyTokens;
+    const auto legacySeconds = MeasureSeconds([&] {
+        for (auto & line : lines) {
+            Legacy::Parse(line, [&](const Legacy::Token& token) {
+                legacyTokens.push_back(token);
+            });
+        }
+    });
+
+    std::printf("legacy:        %zu tokens, %.3f s, %.0f tokens/s (%.1fx)\n",
+        legacyTokens.size(), legacySeconds, legacyTokens.size() / legacySeconds,
+        legacySeconds / seconds);
+
+    std::size_t index = 0;
+    std::size_t mismatchCount = 0;
+    for (auto & line : lines) {
+        segmenter.Parse(line, [&](const PartOfSpeech& pos) {
+            if ((index >= legacyTokens.size())
+                || (pos.text != legacyTokens[index].text)
+                || (pos.tag != legacyTokens[index].tag)) {
+                ++mismatchCount;
+            }
+            ++index;
+        });
+    }
+    if ((mismatchCount > 0) || (index != legacyTokens.size())) {
+        std::printf("error: %zu tokens differ from the legacy segmenter\n", mismatchCount);
+        return 1;
+    }
+    return 0;
+}
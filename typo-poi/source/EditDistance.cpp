@@ -1,13 +1,18 @@
 // Copyright (c) 2015 mogemimi. Distributed under the MIT license.
 
 #include "EditDistance.h"
-#include "utf8.h"
+#include "thirdparty/ConvertUTF.h"
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstdint>
 #include <cstdlib>
 #include <vector>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 namespace somera {
 namespace {
 
@@ -66,9 +71,110 @@ double matchCharacter(char32_t misspell, char32_t suggestion)
     return NoMatch;
 }
 
-double closestMatchDistance(const std::u32string& left, const std::u32string& right)
+// NOTE:
+// The look-ahead of the Boer matcher only considers resynchronizations that
+// skip fewer than this many characters in total, which bounds each mismatch
+// to O(BoerLookAheadWindow^2) comparisons instead of rescanning the rest of
+// both strings. When the next common character is farther away, the result
+// differs from the unbounded matcher, which only happens on strings longer
+// than the window.
+constexpr int BoerLookAheadWindow = 16;
+
+///@brief A forward iterator that decodes valid UTF-8 in place.
+class UTF8Iterator final {
+public:
+    UTF8Iterator(const char* firstIn, const char* lastIn)
+        : first(reinterpret_cast<const UTF8*>(firstIn))
+        , last(reinterpret_cast<const UTF8*>(lastIn))
+    {
+        length = getLength();
+    }
+
+    char32_t operator*() const
+    {
+        assert(first != last);
+        const char32_t c = first[0];
+        switch (length) {
+        case 2:
+            return ((c & 0x1F) << 6) | (first[1] & 0x3F);
+        case 3:
+            return ((c & 0x0F) << 12) | ((first[1] & 0x3F) << 6) | (first[2] & 0x3F);
+        case 4:
+            return ((c & 0x07) << 18) | ((first[1] & 0x3F) << 12)
+                | ((first[2] & 0x3F) << 6) | (first[3] & 0x3F);
+        default:
+            break;
+        }
+        return c;
+    }
+
+    UTF8Iterator& operator++()
+    {
+        assert(first != last);
+        first += length;
+        length = getLength();
+        return *this;
+    }
+
+    bool operator==(const UTF8Iterator& other) const noexcept
+    {
+        return first == other.first;
+    }
+
+    bool operator!=(const UTF8Iterator& other) const noexcept
+    {
+        return first != other.first;
+    }
+
+private:
+    int getLength() const
+    {
+        if ((first == last) || (*first < 0x80)) {
+            return 1;
+        }
+        assert(isLegalUTF8Sequence(first, last));
+        return static_cast<int>(getNumBytesForUTF8(*first));
+    }
+
+    const UTF8* first;
+    const UTF8* last;
+    int length;
+};
+
+bool isLegalUTF8(const std::string& text)
+{
+    auto first = reinterpret_cast<const UTF8*>(text.data());
+    return isLegalUTF8String(&first, first + text.size());
+}
+
+bool isAscii(const std::string& text)
+{
+    unsigned char bits = 0;
+    for (auto c : text) {
+        bits |= static_cast<unsigned char>(c);
+    }
+    return bits < 0x80;
+}
+
+template <typename Iterator>
+std::size_t countCharacters(Iterator first, Iterator last)
+{
+    std::size_t count = 0;
+    for (; first != last; ++first) {
+        ++count;
+    }
+    return count;
+}
+
+template <typename Iterator>
+double closestMatchDistance(
+    const Iterator leftFirst,
+    const Iterator leftLast,
+    const Iterator rightFirst,
+    const Iterator rightLast,
+    std::size_t largerSize)
 {
-    if (left.empty() && right.empty()) {
+    if ((leftFirst == leftLast) && (rightFirst == rightLast)) {
         return 1.0;
     }
 
@@ -79,10 +185,10 @@ double closestMatchDistance(const std::u32string& left, const std::u32string& ri
     CompensatedSumAccumulator<double> accumulator;
     double matchValue = 0;
 
-    auto leftIter = std::begin(left);
-    auto rightIter = std::begin(right);
+    auto leftIter = leftFirst;
+    auto rightIter = rightFirst;
 
-    while (leftIter != std::end(left) && rightIter != std::end(right))
+    while (leftIter != leftLast && rightIter != rightLast)
     {
         const auto matchScore = matchCharacter(*leftIter, *rightIter);
         if (matchScore > 0.0) {
@@ -92,24 +198,19 @@ double closestMatchDistance(const std::u32string& left, const std::u32string& ri
             continue;
         }
 
-        assert(std::begin(left) != std::end(left));
-        assert(std::begin(right) != std::end(right));
-
-        auto leftBest = std::end(left);
-        auto rightBest = std::end(right);
-        int bestCount = std::numeric_limits<int>::max();
+        auto leftBest = leftLast;
+        auto rightBest = rightLast;
+        int bestCount = BoerLookAheadWindow;
         int leftCount = 0;
         int rightCount = 0;
 
-        for (auto leftPoint = leftIter; leftPoint != std::end(left); ++leftPoint) {
-            assert(leftCount == std::distance(leftIter, leftPoint));
+        for (auto leftPoint = leftIter; leftPoint != leftLast; ++leftPoint) {
             if (leftCount + rightCount >= bestCount) {
                 // For fast pruning
                 break;
             }
 
-            for (auto rightPoint = rightIter; rightPoint != std::end(right); ++rightPoint) {
-                assert(rightCount == std::distance(rightIter, rightPoint));
+            for (auto rightPoint = rightIter; rightPoint != rightLast; ++rightPoint) {
                 if (leftCount + rightCount >= bestCount) {
                     // For fast pruning
                     break;
@@ -129,12 +230,16 @@ double closestMatchDistance(const std::u32string& left, const std::u32string& ri
             rightCount = 0;
         }
 
+        if (bestCount == BoerLookAheadWindow) {
+            // NOTE: No match within the window, so skips the mismatched pair.
+            ++leftIter;
+            ++rightIter;
+            continue;
+        }
         leftIter = leftBest;
         rightIter = rightBest;
     }
 
-    const auto largerSize = std::max(left.size(), right.size());
-
     assert(matchValue >= 0);
     return std::min(matchValue, static_cast<double>(largerSize));
 }
@@ -143,11 +248,32 @@ double closestMatchDistance(const std::u32string& left, const std::u32string& ri
 
 double closestMatchFuzzySimilarity_Boer(const std::string& left, const std::string& right)
 {
-    const auto leftUtf32 = somera::toUtf32(left);
-    const auto rightUtf32 = somera::toUtf32(right);
+    double matchValue = 0;
+    std::size_t maxLength = 0;
+
+    if (isAscii(left) && isAscii(right)) {
+        // NOTE: Each byte is a character, so skips decoding.
+        maxLength = std::max(left.size(), right.size());
+        matchValue = closestMatchDistance(
+            left.data(), left.data() + left.size(),
+            right.data(), right.data() + right.size(),
+            maxLength);
+    }
+    else {
+        // NOTE: Invalid UTF-8 is matched as an empty string, like `toUtf32`.
+        const auto leftSize = isLegalUTF8(left) ? left.size() : 0;
+        const auto rightSize = isLegalUTF8(right) ? right.size() : 0;
+        const UTF8Iterator leftFirst(left.data(), left.data() + leftSize);
+        const UTF8Iterator leftLast(left.data() + leftSize, left.data() + leftSize);
+        const UTF8Iterator rightFirst(right.data(), right.data() + rightSize);
+        const UTF8Iterator rightLast(right.data() + rightSize, right.data() + rightSize);
+        maxLength = std::max(
+            countCharacters(leftFirst, leftLast),
+            countCharacters(rightFirst, rightLast));
+        matchValue = closestMatchDistance(leftFirst, leftLast, rightFirst, rightLast, maxLength);
+    }
 
-    const auto maxLength = std::max(leftUtf32.size(), rightUtf32.size());
-    const auto distance = closestMatchDistance(leftUtf32, rightUtf32) / maxLength;
+    const auto distance = matchValue / maxLength;
     return std::min(std::max(distance, 0.0), 1.0);
 }
 
@@ -158,6 +284,22 @@ double closestMatchFuzzySimilarity(const std::string& text1, const std::string&
 
 namespace {
 
+struct LCSScratch {
+    std::vector<int> vertices;
+    std::vector<double> lcsLengths;
+};
+
+LCSScratch& GetLCSScratch(std::size_t size)
+{
+    // NOTE: The buffers are reused across calls and only grow.
+    thread_local LCSScratch scratch;
+    if (scratch.vertices.size() < size) {
+        scratch.vertices.resize(size);
+        scratch.lcsLengths.resize(size);
+    }
+    return scratch;
+}
+
 double computeLCSLengthFuzzy_ONDGreedyAlgorithm_Threshold(
     const std::string& text1,
     const std::string& text2,
@@ -175,26 +317,28 @@ double computeLCSLengthFuzzy_ONDGreedyAlgorithm_Threshold(
     const auto M = static_cast<int>(text1.size());
     const auto N = static_cast<int>(text2.size());
 
-    const auto maxD = M + N;
+    const auto maxD = std::min(M + N, distanceThreshold);
     const auto offset = N;
 
-    std::vector<int> vertices(M + N + 1);
+    // NOTE: Every path to (M, N) ends on this diagonal.
+    const auto lastDiagonal = M - N;
+    if (std::abs(lastDiagonal) > maxD) {
+        return 0.0;
+    }
+
+    auto & scratch = GetLCSScratch(M + N + 1);
+    auto & vertices = scratch.vertices;
+    auto & lcsLengths = scratch.lcsLengths;
 #if !defined(NDEBUG)
     // NOTE:
     // There is no need to initialize with the zero value for array elements,
     // but you have to assign the zero value to `vertices[1 + offset]`.
-    std::fill(std::begin(vertices), std::end(vertices), -1);
+    std::fill(std::begin(vertices), std::next(std::begin(vertices), M + N + 1), -1);
 #endif
     vertices[1 + offset] = 0;
-
-    std::vector<double> lcsLengths(M + N + 1);
     lcsLengths[1 + offset] = 0;
 
     for (int d = 0; d <= maxD; ++d) {
-        if (d > distanceThreshold) {
-            return 0.0;
-        }
-
         const int startK = -std::min(d, (N * 2) - d);
         const int endK = std::min(d, (M * 2) - d);
 
@@ -204,7 +348,17 @@ double computeLCSLengthFuzzy_ONDGreedyAlgorithm_Threshold(
         assert((d > N) ? (startK == -(N * 2 - d)) : (startK == -d));
         assert((d > M) ? (endK == (M * 2 - d)) : (endK == d));
 
-        for (int k = startK; k <= endK; k += 2) {
+        // NOTE:
+        // A diagonal further than `maxD - d` from the last diagonal can't
+        // reach (M, N) within `maxD`, so only the band around it is
+        // explored. The band is one wider on each side at `d - 1`, so every
+        // vertex read below has been computed.
+        int firstK = std::max(startK, lastDiagonal - (maxD - d));
+        int lastK = std::min(endK, lastDiagonal + (maxD - d));
+        firstK += (firstK - startK) % 2;
+        lastK -= (endK - lastK) % 2;
+
+        for (int k = firstK; k <= lastK; k += 2) {
             assert((-N <= k) && (k <= M));
             assert(std::abs(k % 2) == (d % 2));
 
@@ -281,14 +435,43 @@ double closestMatchFuzzySimilarity(
     const std::string& text1,
     const std::string& text2,
     int distanceThreshold)
+{
+    return closestMatchFuzzySimilarity(text1, text2, distanceThreshold, 0.0);
+}
+
+double closestMatchFuzzySimilarity(
+    const std::string& text1,
+    const std::string& text2,
+    int distanceThreshold,
+    double similarityThreshold)
 {
     if (text1.empty() && text2.empty()) {
         return 1.0;
     }
-    auto lcs = computeLCSLengthFuzzy_ONDGreedyAlgorithm_Threshold(text1, text2, distanceThreshold);
-    auto maxLength = static_cast<double>(std::max(text1.size(), text2.size()));
+    const auto M = static_cast<int>(text1.size());
+    const auto N = static_cast<int>(text2.size());
+    auto maxLength = static_cast<double>(std::max(M, N));
     assert(maxLength >= 1.0);
     assert(maxLength != 0);
+
+    // NOTE:
+    // A path to (M, N) with `d` insertions and deletions has (M + N - d) / 2
+    // diagonal edges, and each of them adds at most 1.0 to the LCS length.
+    // `minLCSLength` is the shortest LCS length that reaches the threshold,
+    // so the search can give up after `M + N - minLCSLength * 2` edits.
+    int minLCSLength = std::max(static_cast<int>(similarityThreshold * maxLength), 0);
+    while ((minLCSLength > 0) && ((minLCSLength - 1) / maxLength >= similarityThreshold)) {
+        --minLCSLength;
+    }
+    while ((minLCSLength <= std::min(M, N)) && (minLCSLength / maxLength < similarityThreshold)) {
+        ++minLCSLength;
+    }
+    if (minLCSLength > std::min(M, N)) {
+        return 0.0;
+    }
+    distanceThreshold = std::min(distanceThreshold, M + N - minLCSLength * 2);
+
+    auto lcs = computeLCSLengthFuzzy_ONDGreedyAlgorithm_Threshold(text1, text2, distanceThreshold);
     return lcs / maxLength;
 }
 
@@ -406,6 +589,8 @@ double jaroWinklerDistance(const std::string& left, const std::string& right)
 int levenshteinDistance(const std::string& left, const std::string& right)
 {
 #if 1
+    return levenshteinDistance_BitParallel(left, right);
+#elif 1
     return levenshteinDistance_ONDGreedyAlgorithm(left, right);
 #elif 1
     return levenshteinDistance_DynamicProgramming_LinearSpace(left, right);
@@ -736,6 +921,339 @@ int levenshteinDistance_ONDGreedyAlgorithm_Threshold(
     return M + N;
 }
 
+namespace {
+
+constexpr int BitParallelWordSize = 64;
+
+using BitParallelMatchTable = std::array<uint64_t, 256>;
+
+int popCount64(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+int getBitParallelBlockCount(std::size_t length)
+{
+    return static_cast<int>((length + BitParallelWordSize - 1) / BitParallelWordSize);
+}
+
+void makeMatchTable(const std::string& pattern, BitParallelMatchTable& peq)
+{
+    // NOTE:
+    // peq[c] has bit i set if and only if pattern[i] == c.
+    assert(pattern.size() <= BitParallelWordSize);
+    std::fill(std::begin(peq), std::end(peq), 0);
+    for (std::size_t i = 0; i < pattern.size(); ++i) {
+        peq[static_cast<uint8_t>(pattern[i])] |= (static_cast<uint64_t>(1) << i);
+    }
+}
+
+void makeBlockedMatchTable(const std::string& pattern, std::vector<uint64_t>& peq)
+{
+    // NOTE:
+    // The table is laid out as peq[c * blockCount + block] so that all the
+    // blocks of a character are contiguous in memory.
+    const auto blockCount = getBitParallelBlockCount(pattern.size());
+    peq.assign(256 * blockCount, 0);
+    for (std::size_t i = 0; i < pattern.size(); ++i) {
+        const auto c = static_cast<uint8_t>(pattern[i]);
+        const auto block = static_cast<int>(i / BitParallelWordSize);
+        peq[c * blockCount + block] |= (static_cast<uint64_t>(1) << (i % BitParallelWordSize));
+    }
+}
+
+int levenshteinDistance_BitParallel_SingleWord(
+    const BitParallelMatchTable& peq,
+    int patternLength,
+    const std::string& text)
+{
+    // NOTE:
+    // This algorithm is based on Myers's bit-vector algorithm in
+    // "A Fast Bit-Vector Algorithm for Approximate String Matching Based on
+    // Dynamic Programming", Journal of the ACM (1999), pages 395-415,
+    // with the edit distance formulation by Hyyro (2001).
+    assert(0 < patternLength && patternLength <= BitParallelWordSize);
+
+    const uint64_t lastBit = static_cast<uint64_t>(1) << (patternLength - 1);
+    uint64_t pv = ~static_cast<uint64_t>(0);
+    uint64_t mv = 0;
+    int score = patternLength;
+
+    for (auto c : text) {
+        const auto eq = peq[static_cast<uint8_t>(c)];
+        const auto xv = eq | mv;
+        const auto xh = (((eq & pv) + pv) ^ pv) | eq;
+        auto ph = mv | ~(xh | pv);
+        auto mh = pv & xh;
+        if (ph & lastBit) {
+            ++score;
+        }
+        else if (mh & lastBit) {
+            --score;
+        }
+        // NOTE: The distance of the top row D[0][j] is always j.
+        ph = (ph << 1) | 1;
+        mh = (mh << 1);
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+    }
+    return score;
+}
+
+int levenshteinDistance_BitParallel_Blocked(
+    const std::string& pattern,
+    const std::string& text)
+{
+    // NOTE:
+    // The pattern is split into 64-bit blocks and the horizontal delta is
+    // carried from the lower block to the upper one, as described in
+    // Hyyro's "A Bit-Vector Algorithm for Computing Levenshtein and
+    // Damerau Edit Distances", Nordic Journal of Computing (2003).
+    const auto blockCount = getBitParallelBlockCount(pattern.size());
+    assert(blockCount > 0);
+
+    std::vector<uint64_t> peq;
+    makeBlockedMatchTable(pattern, peq);
+
+    std::vector<uint64_t> pvs(blockCount, ~static_cast<uint64_t>(0));
+    std::vector<uint64_t> mvs(blockCount, 0);
+
+    const auto lastIndex = (pattern.size() - 1) % BitParallelWordSize;
+    const uint64_t lastBit = static_cast<uint64_t>(1) << lastIndex;
+    const uint64_t highBit = static_cast<uint64_t>(1) << (BitParallelWordSize - 1);
+    int score = static_cast<int>(pattern.size());
+
+    for (auto c : text) {
+        const auto eqs = peq.data() + static_cast<uint8_t>(c) * blockCount;
+
+        // NOTE: The horizontal delta at the top row is always +1.
+        int carry = 1;
+        for (int block = 0; block < blockCount; ++block) {
+            auto pv = pvs[block];
+            auto mv = mvs[block];
+            auto eq = eqs[block];
+
+            const auto xv = eq | mv;
+            if (carry < 0) {
+                eq |= 1;
+            }
+            const auto xh = (((eq & pv) + pv) ^ pv) | eq;
+            auto ph = mv | ~(xh | pv);
+            auto mh = pv & xh;
+
+            const auto outBit = (block + 1 < blockCount) ? highBit : lastBit;
+            int nextCarry = 0;
+            if (ph & outBit) {
+                nextCarry = 1;
+            }
+            else if (mh & outBit) {
+                nextCarry = -1;
+            }
+
+            ph <<= 1;
+            mh <<= 1;
+            if (carry < 0) {
+                mh |= 1;
+            }
+            else if (carry > 0) {
+                ph |= 1;
+            }
+            pvs[block] = mh | ~(xv | ph);
+            mvs[block] = ph & xv;
+            carry = nextCarry;
+        }
+        score += carry;
+    }
+    return score;
+}
+
+#if defined(__AVX2__)
+void levenshteinDistance_BitParallel_AVX2(
+    const BitParallelMatchTable& peq,
+    int patternLength,
+    const std::string* texts,
+    int* distances)
+{
+    // NOTE:
+    // Scores four candidates at once, one per 64-bit lane. Every lane shares
+    // the match table of the pattern, so each column is a single gather.
+    constexpr int laneCount = 4;
+    assert(0 < patternLength && patternLength <= BitParallelWordSize);
+
+    std::size_t maxLength = 0;
+    for (int lane = 0; lane < laneCount; ++lane) {
+        maxLength = std::max(maxLength, texts[lane].size());
+    }
+
+    const auto one = _mm256_set1_epi64x(1);
+    const auto allOnes = _mm256_set1_epi64x(-1);
+    const auto lastShift = _mm_cvtsi32_si128(patternLength - 1);
+    const auto peqBase = reinterpret_cast<const long long*>(peq.data());
+
+    auto pv = allOnes;
+    auto mv = _mm256_setzero_si256();
+    auto score = _mm256_set1_epi64x(patternLength);
+
+    for (std::size_t j = 0; j < maxLength; ++j) {
+        alignas(32) long long indices[laneCount];
+        alignas(32) long long actives[laneCount];
+        for (int lane = 0; lane < laneCount; ++lane) {
+            const auto& text = texts[lane];
+            const bool active = (j < text.size());
+            indices[lane] = active ? static_cast<uint8_t>(text[j]) : 0;
+            actives[lane] = active ? -1 : 0;
+        }
+        const auto active = _mm256_load_si256(reinterpret_cast<const __m256i*>(actives));
+        const auto eq = _mm256_i64gather_epi64(
+            peqBase, _mm256_load_si256(reinterpret_cast<const __m256i*>(indices)), 8);
+
+        const auto xv = _mm256_or_si256(eq, mv);
+        const auto eqAndPv = _mm256_and_si256(eq, pv);
+        const auto xh = _mm256_or_si256(
+            _mm256_xor_si256(_mm256_add_epi64(eqAndPv, pv), pv), eq);
+        auto ph = _mm256_or_si256(mv, _mm256_andnot_si256(_mm256_or_si256(xh, pv), allOnes));
+        auto mh = _mm256_and_si256(pv, xh);
+
+        const auto phLast = _mm256_and_si256(_mm256_srl_epi64(ph, lastShift), one);
+        const auto mhLast = _mm256_and_si256(_mm256_srl_epi64(mh, lastShift), one);
+        const auto delta = _mm256_sub_epi64(phLast, mhLast);
+        score = _mm256_add_epi64(score, _mm256_and_si256(delta, active));
+
+        ph = _mm256_or_si256(_mm256_slli_epi64(ph, 1), one);
+        mh = _mm256_slli_epi64(mh, 1);
+        const auto nextPv = _mm256_or_si256(
+            mh, _mm256_andnot_si256(_mm256_or_si256(xv, ph), allOnes));
+        const auto nextMv = _mm256_and_si256(ph, xv);
+
+        // NOTE: Lanes whose candidate has ended keep their last state.
+        pv = _mm256_blendv_epi8(pv, nextPv, active);
+        mv = _mm256_blendv_epi8(mv, nextMv, active);
+    }
+
+    alignas(32) long long scores[laneCount];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(scores), score);
+    for (int lane = 0; lane < laneCount; ++lane) {
+        distances[lane] = static_cast<int>(scores[lane]);
+    }
+}
+#endif
+
+int computeLCSLength_BitParallel_Blocked(
+    const std::string& pattern,
+    const std::string& text)
+{
+    // NOTE:
+    // This algorithm is based on Hyyro's "Bit-Parallel LCS-length
+    // Computation Revisited", AWOCA (2004), pages 16-27.
+    // V' = (V + (V & M)) | (V & ~M), where the addition carries across blocks.
+    const auto blockCount = getBitParallelBlockCount(pattern.size());
+    assert(blockCount > 0);
+
+    std::vector<uint64_t> peq;
+    makeBlockedMatchTable(pattern, peq);
+
+    std::vector<uint64_t> vs(blockCount, ~static_cast<uint64_t>(0));
+
+    for (auto c : text) {
+        const auto eqs = peq.data() + static_cast<uint8_t>(c) * blockCount;
+        uint64_t carry = 0;
+        for (int block = 0; block < blockCount; ++block) {
+            const auto v = vs[block];
+            const auto u = v & eqs[block];
+            const auto sum = v + u;
+            const auto sumWithCarry = sum + carry;
+            carry = ((sum < v) || (sumWithCarry < sum)) ? 1 : 0;
+            vs[block] = sumWithCarry | (v & ~eqs[block]);
+        }
+    }
+
+    // NOTE: The LCS length is the number of zero bits in the pattern range.
+    int lcsLength = 0;
+    for (int block = 0; block < blockCount; ++block) {
+        auto mask = ~static_cast<uint64_t>(0);
+        if (block + 1 == blockCount) {
+            const auto bits = pattern.size() - block * BitParallelWordSize;
+            if (bits < BitParallelWordSize) {
+                mask = (static_cast<uint64_t>(1) << bits) - 1;
+            }
+        }
+        lcsLength += popCount64(~vs[block] & mask);
+    }
+    return lcsLength;
+}
+
+} // unnamed namespace
+
+int levenshteinDistance_BitParallel(
+    const std::string& text1, const std::string& text2)
+{
+    // NOTE:
+    // Like the other `levenshteinDistance_*` functions, this is the distance
+    // without substitution, which equals to M + N - 2 * LCS(text1, text2).
+    const auto lcsLength = computeLCSLength_BitParallel(text1, text2);
+    return static_cast<int>(text1.size() + text2.size()) - lcsLength * 2;
+}
+
+int levenshteinDistance_BitParallel_ReplacementCost1(
+    const std::string& text1, const std::string& text2)
+{
+    if (text1.empty() || text2.empty()) {
+        return static_cast<int>(std::max(text1.size(), text2.size()));
+    }
+
+    // NOTE: The shorter string is used as the pattern to minimize blocks.
+    const auto& pattern = (text1.size() <= text2.size()) ? text1 : text2;
+    const auto& text = (text1.size() <= text2.size()) ? text2 : text1;
+
+    if (pattern.size() > BitParallelWordSize) {
+        return levenshteinDistance_BitParallel_Blocked(pattern, text);
+    }
+
+    BitParallelMatchTable peq;
+    makeMatchTable(pattern, peq);
+    return levenshteinDistance_BitParallel_SingleWord(
+        peq, static_cast<int>(pattern.size()), text);
+}
+
+std::vector<int> levenshteinDistance_BitParallel_ReplacementCost1(
+    const std::string& pattern,
+    const std::vector<std::string>& candidates)
+{
+    std::vector<int> distances(candidates.size(), 0);
+
+    if (pattern.empty() || (pattern.size() > BitParallelWordSize)) {
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            distances[i] = levenshteinDistance_BitParallel_ReplacementCost1(
+                pattern, candidates[i]);
+        }
+        return distances;
+    }
+
+    BitParallelMatchTable peq;
+    makeMatchTable(pattern, peq);
+    const auto patternLength = static_cast<int>(pattern.size());
+
+    std::size_t index = 0;
+#if defined(__AVX2__)
+    for (; index + 4 <= candidates.size(); index += 4) {
+        levenshteinDistance_BitParallel_AVX2(
+            peq, patternLength, candidates.data() + index, distances.data() + index);
+    }
+#endif
+    for (; index < candidates.size(); ++index) {
+        distances[index] = levenshteinDistance_BitParallel_SingleWord(
+            peq, patternLength, candidates[index]);
+    }
+    return distances;
+}
+
 int computeLCSLength_DynamicProgramming(
     const std::string& text1,
     const std::string& text2)
@@ -911,6 +1429,37 @@ int computeLCSLength_ONDGreedyAlgorithm(
     return 0;
 }
 
+int computeLCSLength_BitParallel(
+    const std::string& text1,
+    const std::string& text2)
+{
+    if (text1.empty() || text2.empty()) {
+        return 0;
+    }
+
+    const auto& pattern = (text1.size() <= text2.size()) ? text1 : text2;
+    const auto& text = (text1.size() <= text2.size()) ? text2 : text1;
+
+    if (pattern.size() > BitParallelWordSize) {
+        return computeLCSLength_BitParallel_Blocked(pattern, text);
+    }
+
+    BitParallelMatchTable peq;
+    makeMatchTable(pattern, peq);
+
+    uint64_t v = ~static_cast<uint64_t>(0);
+    for (auto c : text) {
+        const auto u = v & peq[static_cast<uint8_t>(c)];
+        v = (v + u) | (v - u);
+    }
+
+    uint64_t mask = ~static_cast<uint64_t>(0);
+    if (pattern.size() < BitParallelWordSize) {
+        mask = (static_cast<uint64_t>(1) << pattern.size()) - 1;
+    }
+    return popCount64(~v & mask);
+}
+
 std::vector<int> LCS_Column(
     const std::string& x,
     const std::string& y,
@@ -20,6 +20,16 @@ double closestMatchFuzzySimilarity(
     const std::string& right,
     int distanceThreshold);
 
+///@brief Same as above, but returns 0.0 as soon as the similarity can't
+/// reach `similarityThreshold` any more.
+///@param left UTF-8 string
+///@param right UTF-8 string
+double closestMatchFuzzySimilarity(
+    const std::string& left,
+    const std::string& right,
+    int distanceThreshold,
+    double similarityThreshold);
+
 ///@param left UTF-8 string
 ///@param right UTF-8 string
 double closestMatchFuzzySimilarity_Boer(
@@ -69,6 +79,25 @@ int levenshteinDistance_ONDGreedyAlgorithm_Threshold(
     const std::string& right,
     int threshold);
 
+///@param left UTF-8 string
+///@param right UTF-8 string
+int levenshteinDistance_BitParallel(
+    const std::string& left,
+    const std::string& right);
+
+///@param left UTF-8 string
+///@param right UTF-8 string
+int levenshteinDistance_BitParallel_ReplacementCost1(
+    const std::string& left,
+    const std::string& right);
+
+///@brief Computes the distance from `pattern` to each candidate at once.
+///@param pattern UTF-8 string
+///@param candidates UTF-8 strings
+std::vector<int> levenshteinDistance_BitParallel_ReplacementCost1(
+    const std::string& pattern,
+    const std::vector<std::string>& candidates);
+
 ///@param left UTF-8 string
 ///@param right UTF-8 string
 int computeLCSLength_DynamicProgramming(
@@ -81,6 +110,12 @@ int computeLCSLength_ONDGreedyAlgorithm(
     const std::string& left,
     const std::string& right);
 
+///@param left UTF-8 string
+///@param right UTF-8 string
+int computeLCSLength_BitParallel(
+    const std::string& left,
+    const std::string& right);
+
 ///@param left UTF-8 string
 ///@param right UTF-8 string
 int computeLCSLengthInLinearSpace(
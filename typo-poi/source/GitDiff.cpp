@@ -0,0 +1,168 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#include "GitDiff.h"
+#include "somera/StringHelper.h"
+#include "somera/SubprocessHelper.h"
+#include <cassert>
+#include <cstdlib>
+#include <iterator>
+#include <tuple>
+
+namespace somera {
+namespace {
+
+std::string QuoteShellArgument(const std::string& argument)
+{
+    std::string quoted = "'";
+    for (auto c : argument) {
+        if (c == '\'') {
+            quoted += "'\\''";
+        }
+        else {
+            quoted += c;
+        }
+    }
+    quoted += "'";
+    return quoted;
+}
+
+///@brief Decodes a path that git quoted because of special characters,
+/// such as "b/tab\tin\"name\".txt" or "b/caf\303\251.txt".
+std::string UnquotePath(const std::string& path)
+{
+    if ((path.size() < 2) || (path.front() != '"') || (path.back() != '"')) {
+        return path;
+    }
+    std::string result;
+    for (std::size_t i = 1; i + 1 < path.size(); ++i) {
+        if ((path[i] != '\\') || (i + 2 >= path.size())) {
+            result += path[i];
+            continue;
+        }
+        const auto c = path[++i];
+        if ((c >= '0') && (c <= '7') && (i + 3 < path.size())) {
+            result += static_cast<char>(std::strtol(path.substr(i, 3).c_str(), nullptr, 8));
+            i += 2;
+            continue;
+        }
+        switch (c) {
+        case 'a': result += '\a'; break;
+        case 'b': result += '\b'; break;
+        case 'f': result += '\f'; break;
+        case 'n': result += '\n'; break;
+        case 'r': result += '\r'; break;
+        case 't': result += '\t'; break;
+        case 'v': result += '\v'; break;
+        default: result += c; break;
+        }
+    }
+    return result;
+}
+
+///@brief Parses "+first[,count]" in a hunk header such as "@@ -1,2 +3,4 @@".
+bool ParseHunkHeader(const std::string& line, LineRange& range)
+{
+    const auto plus = line.find(" +");
+    if (plus == std::string::npos) {
+        return false;
+    }
+    char* end = nullptr;
+    range.first = std::strtoul(line.c_str() + plus + 2, &end, 10);
+    range.count = 1;
+    if (*end == ',') {
+        range.count = std::strtoul(end + 1, &end, 10);
+    }
+    return *end == ' ';
+}
+
+} // unnamed namespace
+
+std::vector<ChangedFile> ParseUnifiedDiff(const std::string& diff)
+{
+    std::vector<ChangedFile> files;
+    ChangedFile* file = nullptr;
+
+    // NOTE: An added line that starts with "++" looks like a file header,
+    // so the headers are only parsed before the first hunk of each file.
+    bool isHeader = false;
+
+    for (auto & line : StringHelper::split(diff, '\n')) {
+        if (StringHelper::startWith(line, "diff --git ")) {
+            isHeader = true;
+            file = nullptr;
+            continue;
+        }
+        if (isHeader && StringHelper::startWith(line, "+++ ")) {
+            file = nullptr;
+            // NOTE: git appends a tab to a name with spaces for GNU patch.
+            auto name = line.substr(4);
+            if (!name.empty() && (name.back() == '\t')) {
+                name.pop_back();
+            }
+            const auto path = UnquotePath(name);
+            if (!StringHelper::startWith(path, "b/")) {
+                // NOTE: The file was deleted, so the new side is /dev/null.
+                continue;
+            }
+            files.emplace_back();
+            file = &files.back();
+            file->path = path.substr(2);
+            continue;
+        }
+        if (!StringHelper::startWith(line, "@@ ")) {
+            continue;
+        }
+        isHeader = false;
+        if (file == nullptr) {
+            continue;
+        }
+        LineRange range;
+        if (ParseHunkHeader(line, range) && (range.count > 0)) {
+            // NOTE: Adjacent hunks are merged so that a line is read once.
+            auto & ranges = file->lineRanges;
+            if (!ranges.empty() && (ranges.back().first + ranges.back().count == range.first)) {
+                ranges.back().count += range.count;
+            }
+            else {
+                ranges.push_back(range);
+            }
+        }
+    }
+
+    for (auto iter = files.begin(); iter != files.end();) {
+        iter = iter->lineRanges.empty() ? files.erase(iter) : std::next(iter);
+    }
+    return files;
+}
+
+std::error_code GetChangedFiles(
+    const std::string& revision,
+    const std::vector<std::string>& pathspecs,
+    std::vector<ChangedFile>& files)
+{
+    assert(!revision.empty());
+
+    // NOTE:
+    // The options override the user's configuration that would change the
+    // output, such as external diff tools, colors, prefixes and the octal
+    // escaping of non-ASCII paths.
+    std::string command = "git -c core.quotePath=false diff"
+        " --unified=0 --no-color --no-ext-diff --no-textconv --relative"
+        " --src-prefix=a/ --dst-prefix=b/ --diff-filter=d ";
+    command += QuoteShellArgument(revision);
+    command += " --";
+    for (auto & pathspec : pathspecs) {
+        command += " " + QuoteShellArgument(pathspec);
+    }
+
+    std::string diff;
+    std::error_code errorCode;
+    std::tie(diff, errorCode) = SubprocessHelper::call(command);
+    if (errorCode) {
+        return errorCode;
+    }
+    files = ParseUnifiedDiff(diff);
+    return {};
+}
+
+} // namespace somera
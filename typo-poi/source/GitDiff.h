@@ -0,0 +1,33 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#pragma once
+
+#include "TextReader.h"
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace somera {
+
+struct ChangedFile {
+    std::string path;
+
+    ///@brief The added or modified lines of the new file, sorted.
+    std::vector<LineRange> lineRanges;
+};
+
+///@brief Parses the output of `git diff --unified=0`. Files without
+/// added lines, such as deleted or binary files, are left out.
+std::vector<ChangedFile> ParseUnifiedDiff(const std::string& diff);
+
+///@brief Collects the lines that changed in the working tree since
+/// `revision`, limited to `pathspecs` unless it is empty.
+///
+/// Like `git diff --relative`, the paths are relative to the current
+/// directory and changes outside of it are ignored.
+std::error_code GetChangedFiles(
+    const std::string& revision,
+    const std::vector<std::string>& pathspecs,
+    std::vector<ChangedFile>& files);
+
+} // namespace somera
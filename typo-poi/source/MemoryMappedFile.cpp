@@ -0,0 +1,126 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#include "MemoryMappedFile.h"
+#include <cassert>
+
+#if defined(_MSC_VER)
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace somera {
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    Close();
+}
+
+std::error_code MemoryMappedFile::Open(const std::string& path)
+{
+    Close();
+
+#if defined(_MSC_VER)
+    auto file = ::CreateFileA(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return std::error_code(static_cast<int>(::GetLastError()), std::system_category());
+    }
+
+    LARGE_INTEGER fileSize;
+    if (::GetFileSizeEx(file, &fileSize) == 0) {
+        std::error_code errorCode(static_cast<int>(::GetLastError()), std::system_category());
+        ::CloseHandle(file);
+        return errorCode;
+    }
+    if (fileSize.QuadPart == 0) {
+        ::CloseHandle(file);
+        return {};
+    }
+
+    auto mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        std::error_code errorCode(static_cast<int>(::GetLastError()), std::system_category());
+        ::CloseHandle(file);
+        return errorCode;
+    }
+
+    auto view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        std::error_code errorCode(static_cast<int>(::GetLastError()), std::system_category());
+        ::CloseHandle(mapping);
+        ::CloseHandle(file);
+        return errorCode;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = static_cast<const char*>(view);
+    size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    const auto descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor == -1) {
+        return std::error_code(errno, std::generic_category());
+    }
+
+    struct stat statBuf;
+    if (::fstat(descriptor, &statBuf) == -1) {
+        std::error_code errorCode(errno, std::generic_category());
+        ::close(descriptor);
+        return errorCode;
+    }
+    if (statBuf.st_size == 0) {
+        ::close(descriptor);
+        return {};
+    }
+
+    const auto fileSize = static_cast<std::size_t>(statBuf.st_size);
+    auto view = ::mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, descriptor, 0);
+
+    // NOTE: The mapping stays valid after the descriptor is closed.
+    ::close(descriptor);
+
+    if (view == MAP_FAILED) {
+        return std::error_code(errno, std::generic_category());
+    }
+
+    data = static_cast<const char*>(view);
+    size = fileSize;
+#endif
+    return {};
+}
+
+void MemoryMappedFile::Close() noexcept
+{
+#if defined(_MSC_VER)
+    if (data != nullptr) {
+        ::UnmapViewOfFile(data);
+    }
+    if (mappingHandle != nullptr) {
+        ::CloseHandle(mappingHandle);
+    }
+    if (fileHandle != nullptr) {
+        ::CloseHandle(fileHandle);
+    }
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    if (data != nullptr) {
+        ::munmap(const_cast<char*>(data), size);
+    }
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+} // namespace somera
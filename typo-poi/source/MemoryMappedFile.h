@@ -0,0 +1,45 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <system_error>
+
+namespace somera {
+
+class MemoryMappedFile final {
+public:
+    MemoryMappedFile() = default;
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    ~MemoryMappedFile();
+
+    ///@brief Maps the whole file read-only. An empty file maps to no data.
+    std::error_code Open(const std::string& path);
+
+    void Close() noexcept;
+
+    const char* GetData() const noexcept
+    {
+        return data;
+    }
+
+    std::size_t GetSize() const noexcept
+    {
+        return size;
+    }
+
+private:
+    const char* data = nullptr;
+    std::size_t size = 0;
+#if defined(_MSC_VER)
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+} // namespace somera
@@ -0,0 +1,301 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#include "ScanResultCache.h"
+#include "MemoryMappedFile.h"
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace somera {
+namespace {
+
+// NOTE:
+// The cache file is laid out as follows:
+//
+//   char magic[8]
+//   uint32_t version
+//   uint32_t reserved
+//   uint64_t dictionaryFingerprint
+//   uint64_t entryCount
+//   Entry[entryCount]
+//
+// Entry:
+//   uint64_t contentHash
+//   uint64_t contentSize
+//   uint32_t typoCount
+//   Typo[typoCount]
+//
+// Typo:
+//   String misspelledWord
+//   uint32_t correctionCount
+//   String corrections[correctionCount]
+//
+// String:
+//   uint32_t length
+//   char text[length]
+constexpr char ScanResultCacheMagic[8] = {'T', 'Y', 'P', 'O', 'S', 'C', 'A', 'N'};
+
+// NOTE: Bump this when a change to the spell checker changes the typos found.
+constexpr uint32_t ScanResultCacheVersion = 1;
+
+class CacheReader final {
+public:
+    CacheReader(const char* firstIn, const char* lastIn)
+        : first(firstIn)
+        , last(lastIn)
+    {
+    }
+
+    template <typename T>
+    bool Read(T & value)
+    {
+        if (static_cast<std::size_t>(last - first) < sizeof(value)) {
+            return false;
+        }
+        std::memcpy(&value, first, sizeof(value));
+        first += sizeof(value);
+        return true;
+    }
+
+    bool Read(std::string & text)
+    {
+        uint32_t length = 0;
+        if (!Read(length) || (static_cast<std::size_t>(last - first) < length)) {
+            return false;
+        }
+        text.assign(first, length);
+        first += length;
+        return true;
+    }
+
+    bool IsEnd() const noexcept
+    {
+        return first == last;
+    }
+
+private:
+    const char* first;
+    const char* last;
+};
+
+template <typename T>
+void Write(std::ostream & stream, const T& value)
+{
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void Write(std::ostream & stream, const std::string& text)
+{
+    Write(stream, static_cast<uint32_t>(text.size()));
+    stream.write(text.data(), text.size());
+}
+
+} // unnamed namespace
+
+uint64_t HashBytes(uint64_t hash, const char* data, std::size_t size)
+{
+    constexpr uint64_t prime = 1099511628211ULL;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= prime;
+    }
+    return hash;
+}
+
+std::error_code ComputeFileContentHash(const std::string& path, ContentHash& contentHash)
+{
+    MemoryMappedFile file;
+    if (auto errorCode = file.Open(path)) {
+        return errorCode;
+    }
+    contentHash.hash = HashBytes(InitialContentHash, file.GetData(), file.GetSize());
+    contentHash.size = file.GetSize();
+    return {};
+}
+
+ScanResultCache::ScanResultCache(uint64_t dictionaryFingerprintIn)
+    : dictionaryFingerprint(dictionaryFingerprintIn)
+{
+}
+
+std::error_code ScanResultCache::Load(const std::string& path)
+{
+    MemoryMappedFile file;
+    if (auto errorCode = file.Open(path)) {
+        return errorCode;
+    }
+
+    const auto invalidFile = std::make_error_code(std::errc::invalid_argument);
+    CacheReader reader(file.GetData(), file.GetData() + file.GetSize());
+
+    char magic[sizeof(ScanResultCacheMagic)];
+    uint32_t version = 0;
+    uint32_t reserved = 0;
+    uint64_t fingerprint = 0;
+    uint64_t entryCount = 0;
+    if (!reader.Read(magic)
+        || !reader.Read(version)
+        || !reader.Read(reserved)
+        || !reader.Read(fingerprint)
+        || !reader.Read(entryCount)) {
+        return invalidFile;
+    }
+    if ((std::memcmp(magic, ScanResultCacheMagic, sizeof(magic)) != 0)
+        || (version != ScanResultCacheVersion)) {
+        return invalidFile;
+    }
+    if (fingerprint != dictionaryFingerprint) {
+        // NOTE: A dictionary has changed since the cache was saved.
+        return {};
+    }
+
+    std::unordered_map<uint64_t, Entry> newEntries;
+    std::list<uint64_t> newRecentHashes;
+    for (uint64_t i = 0; i < entryCount; ++i) {
+        uint64_t contentHash = 0;
+        Entry entry;
+        entry.used = false;
+        uint32_t typoCount = 0;
+        if (!reader.Read(contentHash) || !reader.Read(entry.size) || !reader.Read(typoCount)) {
+            return invalidFile;
+        }
+        for (uint32_t k = 0; k < typoCount; ++k) {
+            Typo typo;
+            uint32_t correctionCount = 0;
+            if (!reader.Read(typo.misspelledWord) || !reader.Read(correctionCount)) {
+                return invalidFile;
+            }
+            for (uint32_t c = 0; c < correctionCount; ++c) {
+                std::string correction;
+                if (!reader.Read(correction)) {
+                    return invalidFile;
+                }
+                typo.corrections.push_back(std::move(correction));
+            }
+            entry.typos.push_back(std::move(typo));
+        }
+        auto result = newEntries.emplace(contentHash, std::move(entry));
+        if (result.second) {
+            newRecentHashes.push_back(contentHash);
+            result.first->second.recency = std::prev(std::end(newRecentHashes));
+        }
+    }
+    if (!reader.IsEnd()) {
+        return invalidFile;
+    }
+    std::swap(entries, newEntries);
+    std::swap(recentHashes, newRecentHashes);
+    EvictOverflow();
+    return {};
+}
+
+std::error_code ScanResultCache::Save(const std::string& path) const
+{
+    uint64_t entryCount = 0;
+    for (auto & pair : entries) {
+        if (pair.second.used) {
+            ++entryCount;
+        }
+    }
+
+    // NOTE: Writes to a temporary file first so that an interrupted run
+    // never leaves a broken cache behind.
+    const auto temporaryPath = path + ".tmp";
+    {
+        std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!output) {
+            return std::make_error_code(std::errc::permission_denied);
+        }
+        output.write(ScanResultCacheMagic, sizeof(ScanResultCacheMagic));
+        Write(output, ScanResultCacheVersion);
+        Write(output, static_cast<uint32_t>(0));
+        Write(output, dictionaryFingerprint);
+        Write(output, entryCount);
+
+        for (auto & pair : entries) {
+            auto & entry = pair.second;
+            if (!entry.used) {
+                continue;
+            }
+            Write(output, pair.first);
+            Write(output, entry.size);
+            Write(output, static_cast<uint32_t>(entry.typos.size()));
+            for (auto & typo : entry.typos) {
+                Write(output, typo.misspelledWord);
+                Write(output, static_cast<uint32_t>(typo.corrections.size()));
+                for (auto & correction : typo.corrections) {
+                    Write(output, correction);
+                }
+            }
+        }
+        if (!output) {
+            std::remove(temporaryPath.c_str());
+            return std::make_error_code(std::errc::io_error);
+        }
+    }
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        return std::make_error_code(std::errc::io_error);
+    }
+    return {};
+}
+
+const std::vector<Typo>* ScanResultCache::Find(const ContentHash& contentHash)
+{
+    auto iter = entries.find(contentHash.hash);
+    if ((iter == std::end(entries)) || (iter->second.size != contentHash.size)) {
+        return nullptr;
+    }
+    iter->second.used = true;
+    Touch(iter->second);
+    return &iter->second.typos;
+}
+
+void ScanResultCache::Insert(const ContentHash& contentHash, const std::vector<Typo>& typos)
+{
+    auto result = entries.emplace(contentHash.hash, Entry{});
+    auto & entry = result.first->second;
+    entry.size = contentHash.size;
+    entry.typos = typos;
+    entry.used = true;
+    if (result.second) {
+        recentHashes.push_front(contentHash.hash);
+        entry.recency = std::begin(recentHashes);
+        EvictOverflow();
+    }
+    else {
+        Touch(entry);
+    }
+}
+
+void ScanResultCache::SetCapacity(std::size_t capacityIn)
+{
+    capacity = capacityIn;
+    EvictOverflow();
+}
+
+std::size_t ScanResultCache::GetSize() const noexcept
+{
+    return entries.size();
+}
+
+void ScanResultCache::Touch(Entry& entry)
+{
+    recentHashes.splice(std::begin(recentHashes), recentHashes, entry.recency);
+}
+
+void ScanResultCache::EvictOverflow()
+{
+    if (capacity == 0) {
+        return;
+    }
+    while (entries.size() > capacity) {
+        assert(!recentHashes.empty());
+        entries.erase(recentHashes.back());
+        recentHashes.pop_back();
+    }
+}
+
+} // namespace somera
@@ -0,0 +1,78 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#pragma once
+
+#include "Typo.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace somera {
+
+constexpr uint64_t InitialContentHash = 14695981039346656037ULL;
+
+///@brief Folds `data` into `hash` with 64-bit FNV-1a.
+uint64_t HashBytes(uint64_t hash, const char* data, std::size_t size);
+
+struct ContentHash {
+    uint64_t hash = InitialContentHash;
+    uint64_t size = 0;
+};
+
+///@brief Hashes the contents of the file.
+std::error_code ComputeFileContentHash(const std::string& path, ContentHash& contentHash);
+
+///@brief A persistent cache of the typos found in each file, keyed by the
+/// content hash of the file.
+///
+/// The cache belongs to a single dictionary fingerprint. A cache file saved
+/// with another fingerprint loads as empty, so changing any dictionary
+/// invalidates all the entries.
+class ScanResultCache final {
+public:
+    explicit ScanResultCache(uint64_t dictionaryFingerprint);
+
+    ///@brief Reads the entries of a cache file saved with the same fingerprint.
+    std::error_code Load(const std::string& path);
+
+    ///@brief Writes the entries that were found or inserted since `Load`,
+    /// so that files which no longer exist drop out of the cache.
+    std::error_code Save(const std::string& path) const;
+
+    ///@brief Returns the typos cached for the content, or `nullptr`.
+    const std::vector<Typo>* Find(const ContentHash& contentHash);
+
+    void Insert(const ContentHash& contentHash, const std::vector<Typo>& typos);
+
+    ///@brief Keeps at most `capacity` entries, dropping the least recently
+    /// used ones first. Zero, the default, means no limit.
+    void SetCapacity(std::size_t capacity);
+
+    std::size_t GetSize() const noexcept;
+
+private:
+    struct Entry {
+        uint64_t size;
+        std::vector<Typo> typos;
+        std::list<uint64_t>::iterator recency;
+        bool used;
+    };
+
+    void Touch(Entry& entry);
+
+    void EvictOverflow();
+
+    std::unordered_map<uint64_t, Entry> entries;
+
+    ///@brief The content hashes of `entries`, most recently used first.
+    std::list<uint64_t> recentHashes;
+
+    uint64_t dictionaryFingerprint;
+    std::size_t capacity = 0;
+};
+
+} // namespace somera
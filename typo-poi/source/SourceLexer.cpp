@@ -0,0 +1,349 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#include "SourceLexer.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace somera {
+namespace {
+
+std::vector<StringView> MakeKeywordTable()
+{
+    // NOTE: The C++14 keywords and alternative tokens, and the C11 keywords.
+    std::vector<StringView> keywords = {
+        "_Alignas", "_Alignof", "_Atomic", "_Bool", "_Complex", "_Generic",
+        "_Imaginary", "_Noreturn", "_Static_assert", "_Thread_local",
+        "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand",
+        "bitor", "bool", "break", "case", "catch", "char", "char16_t",
+        "char32_t", "class", "compl", "const", "const_cast", "constexpr",
+        "continue", "decltype", "default", "delete", "do", "double",
+        "dynamic_cast", "else", "enum", "explicit", "export", "extern",
+        "false", "float", "for", "friend", "goto", "if", "inline", "int",
+        "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+        "nullptr", "operator", "or", "or_eq", "private", "protected",
+        "public", "register", "reinterpret_cast", "restrict", "return",
+        "short", "signed", "sizeof", "static", "static_assert",
+        "static_cast", "struct", "switch", "template", "this",
+        "thread_local", "throw", "true", "try", "typedef", "typeid",
+        "typename", "union", "unsigned", "using", "virtual", "void",
+        "volatile", "wchar_t", "while", "xor", "xor_eq",
+    };
+    std::sort(std::begin(keywords), std::end(keywords));
+    return keywords;
+}
+
+const std::vector<StringView> keywords = MakeKeywordTable();
+
+bool IsKeyword(const StringView& text)
+{
+    return std::binary_search(std::begin(keywords), std::end(keywords), text);
+}
+
+bool IsLiteralPrefix(const StringView& text)
+{
+    for (auto prefix : {"L", "u", "U", "u8", "R", "LR", "uR", "UR", "u8R"}) {
+        if (text == prefix) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IsSpace(char c) noexcept
+{
+    return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\v') || (c == '\f');
+}
+
+bool IsDigit(char c) noexcept
+{
+    return (c >= '0') && (c <= '9');
+}
+
+bool IsIdentifierHead(char c) noexcept
+{
+    // NOTE: The bytes of UTF-8 characters are also allowed in identifiers.
+    return ((c >= 'a') && (c <= 'z'))
+        || ((c >= 'A') && (c <= 'Z'))
+        || (c == '_')
+        || (static_cast<uint8_t>(c) >= 0x80);
+}
+
+bool IsIdentifierTail(char c) noexcept
+{
+    return IsIdentifierHead(c) || IsDigit(c);
+}
+
+class SourceLexer final {
+public:
+    SourceLexer(StringView source, const std::function<void(const SourceToken&)>& callbackIn)
+        : current(source.data())
+        , last(source.data() + source.size())
+        , lineFirst(source.data())
+        , callback(callbackIn)
+    {
+    }
+
+    void Lex();
+
+private:
+    void LexLineComment();
+
+    void LexBlockComment();
+
+    void LexString();
+
+    void LexRawString();
+
+    void LexCharacter();
+
+    void LexNumber();
+
+    void LexIdentifier(bool isDirective);
+
+    ///@brief Calls `callback` with [first, end), which must start on the current line.
+    void Emit(const char* first, const char* end, SourceTokenKind kind);
+
+    ///@brief Moves to `p` and counts the lines on the way.
+    void SkipTo(const char* p);
+
+    ///@brief Returns the end of the quoted text that starts at `first`.
+    const char* FindClosingQuote(const char* first, char quote) const;
+
+private:
+    const char* current;
+    const char* last;
+    const char* lineFirst;
+    std::size_t line = 1;
+    const std::function<void(const SourceToken&)>& callback;
+};
+
+void SourceLexer::Lex()
+{
+    // NOTE: A '#' that starts a line makes the next identifier a directive name.
+    bool isLineStart = true;
+    bool isDirective = false;
+
+    while (current != last) {
+        const auto c = *current;
+        if (c == '\n') {
+            SkipTo(current + 1);
+            isLineStart = true;
+            isDirective = false;
+            continue;
+        }
+        if (IsSpace(c)) {
+            ++current;
+            continue;
+        }
+
+        const auto next = (std::next(current) != last) ? *std::next(current) : '\0';
+        if ((c == '/') && (next == '/')) {
+            LexLineComment();
+        }
+        else if ((c == '/') && (next == '*')) {
+            LexBlockComment();
+        }
+        else if (c == '"') {
+            LexString();
+        }
+        else if (c == '\'') {
+            LexCharacter();
+        }
+        else if (IsDigit(c) || ((c == '.') && IsDigit(next))) {
+            LexNumber();
+        }
+        else if (IsIdentifierHead(c)) {
+            LexIdentifier(isDirective);
+            isDirective = false;
+        }
+        else {
+            isDirective = (c == '#') && isLineStart;
+            ++current;
+        }
+        isLineStart = false;
+    }
+}
+
+void SourceLexer::LexLineComment()
+{
+    const auto first = current + 2;
+    auto end = first;
+    for (;;) {
+        end = std::find(end, last, '\n');
+        if (end == last) {
+            break;
+        }
+        // NOTE: A backslash at the end of the line continues the comment.
+        auto lineEnd = end;
+        if ((lineEnd != first) && (*std::prev(lineEnd) == '\r')) {
+            --lineEnd;
+        }
+        if ((lineEnd == first) || (*std::prev(lineEnd) != '\\')) {
+            break;
+        }
+        ++end;
+    }
+    Emit(first, end, SourceTokenKind::Comment);
+    SkipTo(end);
+}
+
+void SourceLexer::LexBlockComment()
+{
+    const auto first = current + 2;
+    const char terminator[] = "*/";
+    const auto end = std::search(first, last, terminator, terminator + 2);
+    Emit(first, end, SourceTokenKind::Comment);
+    SkipTo((end != last) ? (end + 2) : last);
+}
+
+const char* SourceLexer::FindClosingQuote(const char* first, char quote) const
+{
+    // NOTE: An unterminated literal ends at the end of the line.
+    auto end = first;
+    while ((end != last) && (*end != quote) && (*end != '\n')) {
+        if ((*end == '\\') && (std::next(end) != last)) {
+            ++end;
+        }
+        ++end;
+    }
+    return end;
+}
+
+void SourceLexer::LexString()
+{
+    assert(*current == '"');
+    const auto first = current + 1;
+    const auto end = FindClosingQuote(first, '"');
+    Emit(first, end, SourceTokenKind::StringLiteral);
+    SkipTo(((end != last) && (*end == '"')) ? (end + 1) : end);
+}
+
+void SourceLexer::LexRawString()
+{
+    assert(*current == '"');
+
+    // NOTE: R"delimiter(...)delimiter", where the delimiter has at most 16 characters.
+    const auto delimiterFirst = current + 1;
+    const auto limit = delimiterFirst + std::min<std::ptrdiff_t>(17, last - delimiterFirst);
+    const auto delimiterLast = std::find_if(delimiterFirst, limit, [](char c) {
+        return (c == '(') || (c == ')') || (c == '\\') || (c == '"') || (c == '\n') || IsSpace(c);
+    });
+    if ((delimiterLast == limit) || (*delimiterLast != '(')) {
+        LexString();
+        return;
+    }
+
+    std::string terminator = ")";
+    terminator.append(delimiterFirst, delimiterLast);
+    terminator += '"';
+
+    const auto first = std::next(delimiterLast);
+    const auto end = std::search(first, last, std::begin(terminator), std::end(terminator));
+    Emit(first, end, SourceTokenKind::StringLiteral);
+    SkipTo((end != last) ? (end + terminator.size()) : last);
+}
+
+void SourceLexer::LexCharacter()
+{
+    assert(*current == '\'');
+    const auto end = FindClosingQuote(current + 1, '\'');
+    SkipTo(((end != last) && (*end == '\'')) ? (end + 1) : end);
+}
+
+void SourceLexer::LexNumber()
+{
+    // NOTE: A preprocessing number, such as "0x1Fu", "1.5e-3f" or "1'000'000".
+    auto end = current;
+    while (end != last) {
+        const auto c = *end;
+        if (IsIdentifierTail(c) || (c == '.')) {
+            ++end;
+            continue;
+        }
+        if (((c == '+') || (c == '-')) && (std::strchr("eEpP", *std::prev(end)) != nullptr)) {
+            ++end;
+            continue;
+        }
+        if ((c == '\'') && (std::next(end) != last) && IsIdentifierTail(*std::next(end))) {
+            ++end;
+            continue;
+        }
+        break;
+    }
+    current = end;
+}
+
+void SourceLexer::LexIdentifier(bool isDirective)
+{
+    const auto first = current;
+    const auto end = std::find_if_not(first, last, IsIdentifierTail);
+    const StringView text(first, end - first);
+    current = end;
+
+    if ((end != last) && ((*end == '"') || (*end == '\'')) && IsLiteralPrefix(text)) {
+        if (*end == '\'') {
+            LexCharacter();
+        }
+        else if (*std::prev(end) == 'R') {
+            LexRawString();
+        }
+        else {
+            LexString();
+        }
+        return;
+    }
+    if (!isDirective && !IsKeyword(text)) {
+        Emit(first, end, SourceTokenKind::Identifier);
+    }
+}
+
+void SourceLexer::Emit(const char* first, const char* end, SourceTokenKind kind)
+{
+    assert(first >= lineFirst);
+    if (first == end) {
+        return;
+    }
+
+    SourceToken token;
+    token.text = StringView(first, end - first);
+    token.kind = kind;
+    token.position.line = line;
+    token.position.column = std::count_if(lineFirst, first, [](char c) {
+        // NOTE: Counts the characters, skipping the UTF-8 continuation bytes.
+        return (static_cast<uint8_t>(c) & 0xC0) != 0x80;
+    });
+    callback(token);
+}
+
+void SourceLexer::SkipTo(const char* p)
+{
+    assert(current <= p);
+    assert(p <= last);
+    for (;;) {
+        auto lineEnd = static_cast<const char*>(std::memchr(current, '\n', p - current));
+        if (lineEnd == nullptr) {
+            break;
+        }
+        ++line;
+        current = lineEnd + 1;
+        lineFirst = current;
+    }
+    current = p;
+}
+
+} // unnamed namespace
+
+void LexSource(
+    StringView source,
+    const std::function<void(const SourceToken&)>& callback)
+{
+    assert(callback);
+    SourceLexer lexer(source, callback);
+    lexer.Lex();
+}
+
+} // namespace somera
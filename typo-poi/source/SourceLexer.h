@@ -0,0 +1,45 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#pragma once
+
+#include "TextReader.h"
+#include "somera/StringView.h"
+#include <functional>
+
+namespace somera {
+
+enum class SourceTokenKind {
+    ///@brief The text between "//" and the end of the line, or between
+    /// "/*" and "*/".
+    Comment,
+
+    ///@brief The characters of a string literal without the prefix and the
+    /// quotes, or the delimiters of a raw string literal.
+    StringLiteral,
+
+    ///@brief An identifier that is not a keyword.
+    Identifier,
+};
+
+struct SourceToken {
+    ///@brief A view into the text passed to `LexSource`.
+    StringView text;
+
+    ///@brief The position of the first character of `text`.
+    TextPosition position;
+
+    SourceTokenKind kind;
+};
+
+///@brief Lexes C/C++ source code in one pass, and calls `callback` for
+/// each comment, string literal and identifier.
+///
+/// Keywords, preprocessor directive names, numbers, character literals and
+/// punctuators are skipped. The lexer doesn't run the preprocessor, and it
+/// lexes broken code as far as it can, such as an unterminated string up to
+/// the end of the line.
+void LexSource(
+    StringView source,
+    const std::function<void(const SourceToken&)>& callback);
+
+} // namespace somera
@@ -2,11 +2,23 @@
 
 #include "SpellChecker.h"
 #include "EditDistance.h"
+#include "MemoryMappedFile.h"
 #include "StringHelper.h"
 #include "Optional.h"
+#include "somera/ParallelFor.h"
+#include "somera/StringView.h"
+#include <array>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace somera {
 namespace {
@@ -81,375 +93,3010 @@ uint32_t SignatureHashingFromAsciiAlphabet(const std::string& word)
     return hash;
 }
 
-class SpellCheckerSignatureHashing final : public SpellChecker {
-public:
-    SpellCheckResult Suggest(const std::string& word);
+using CharacterMaskTable = std::array<uint64_t, 256>;
 
-    void AddWord(const std::string& word);
+CharacterMaskTable MakeCharacterMaskTable()
+{
+    // NOTE:
+    // Maps each byte to a bit of the character presence mask. Upper and lower
+    // case letters share a bit because `closestMatchFuzzySimilarity` matches
+    // them to each other. Symbols may share bits, and all non-ASCII bytes
+    // share the last one; that only makes the mask less selective.
+    CharacterMaskTable table;
+    for (int c = 0; c < 256; ++c) {
+        int bit = 63;
+        if ('a' <= c && c <= 'z') {
+            bit = c - 'a';
+        }
+        else if ('A' <= c && c <= 'Z') {
+            bit = c - 'A';
+        }
+        else if ('0' <= c && c <= '9') {
+            bit = 26 + (c - '0');
+        }
+        else if (c < 128) {
+            bit = 36 + (c % 27);
+        }
+        table[c] = static_cast<uint64_t>(1) << bit;
+    }
+    return table;
+}
 
-    void RemoveWord(const std::string& word);
+const CharacterMaskTable characterMasks = MakeCharacterMaskTable();
 
-private:
-    std::unordered_map<uint32_t, std::vector<std::string>> hashedDictionary;
+uint64_t ComputeCharacterMask(const char* data, std::size_t size)
+{
+    uint64_t mask = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        mask |= characterMasks[static_cast<uint8_t>(data[i])];
+    }
+    return mask;
+}
+
+int PopCount(uint64_t bits)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(bits);
+#else
+    bits = bits - ((bits >> 1) & 0x5555555555555555ULL);
+    bits = (bits & 0x3333333333333333ULL) + ((bits >> 2) & 0x3333333333333333ULL);
+    bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((bits * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+///@brief A bucket of sorted words that share a signature, stored as a
+/// struct of arrays next to a string pool.
+struct WordBucket {
+    ///@brief `wordCount + 1` offsets into `stringPool`.
+    const uint32_t* offsets = nullptr;
+
+    ///@brief `ComputeCharacterMask` of each word.
+    const uint64_t* masks = nullptr;
+
+    const char* stringPool = nullptr;
+    uint32_t wordCount = 0;
 };
 
-void SpellCheckerSignatureHashing::AddWord(const std::string& word)
+uint32_t GetWordLength(const WordBucket& bucket, uint32_t index)
 {
-    assert(!word.empty());
+    assert(index < bucket.wordCount);
+    return bucket.offsets[index + 1] - bucket.offsets[index];
+}
 
-    auto signatureHash = SignatureHashingFromAsciiAlphabet(word);
-    auto mapIter = hashedDictionary.find(signatureHash);
-    if (mapIter == std::end(hashedDictionary)) {
-        std::vector<std::string> dict;
-        hashedDictionary.emplace(signatureHash, std::move(dict));
-        mapIter = hashedDictionary.find(signatureHash);
-    }
-    assert(mapIter != std::end(hashedDictionary));
+StringView GetWord(const WordBucket& bucket, uint32_t index)
+{
+    assert(index < bucket.wordCount);
+    return StringView(bucket.stringPool + bucket.offsets[index], GetWordLength(bucket, index));
+}
 
-    auto & words = mapIter->second;
-    auto wordsIter = std::lower_bound(std::begin(words), std::end(words), word);
-    if ((wordsIter != std::end(words)) && (*wordsIter == word)) {
-        // NOTE: The word already exists in a dictionary.
-        return;
+///@brief Returns the index of the first word that is not less than `word`.
+uint32_t LowerBound(const WordBucket& bucket, StringView word)
+{
+    uint32_t first = 0;
+    uint32_t count = bucket.wordCount;
+    while (count > 0) {
+        const auto step = count / 2;
+        if (GetWord(bucket, first + step) < word) {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else {
+            count = step;
+        }
     }
-    words.insert(wordsIter, word);
+    return first;
 }
 
-void SpellCheckerSignatureHashing::RemoveWord(const std::string& word)
+bool ContainsWord(const WordBucket& bucket, StringView word)
 {
-    auto signatureHash = SignatureHashingFromAsciiAlphabet(word);
-    auto mapIter = hashedDictionary.find(signatureHash);
-    if (mapIter == std::end(hashedDictionary)) {
-        return;
-    }
-    assert(mapIter != std::end(hashedDictionary));
+    const auto index = LowerBound(bucket, word);
+    return (index < bucket.wordCount) && (GetWord(bucket, index) == word);
+}
 
-    auto & words = mapIter->second;
-    auto wordsIter = std::lower_bound(std::begin(words), std::end(words), word);
-    if ((wordsIter != std::end(words)) && (*wordsIter == word)) {
-        words.erase(wordsIter);
-    }
+bool IsUpperAscii(char c)
+{
+    return ('A' <= c) && (c <= 'Z');
 }
 
-size_t StringLength(const std::string& s)
+char ToLowerAscii(char c)
 {
-    // TODO: This function is not supported UTF-8 strings.
-    return s.size();
+    return IsUpperAscii(c) ? static_cast<char>(c - 'A' + 'a') : c;
 }
 
-size_t ComputeGapSize(size_t a, size_t b)
+bool EqualsIgnoringCase(StringView a, StringView b)
 {
-    if (a > b) {
-        assert((a - b) <= a);
-        return a - b;
+    if (a.size() != b.size()) {
+        return false;
     }
-    assert((b - a) <= b);
-    return b - a;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (ToLowerAscii(a[i]) != ToLowerAscii(b[i])) {
+            return false;
+        }
+    }
+    return true;
 }
 
-struct SpellSuggestion {
-    std::string word;
-    Optional<double> similarity;
+///@brief A slot of the open-addressing table that finds a dictionary word
+/// by its lower case form, so that a correctly spelled word is found
+/// without walking its signature bucket. The same slots are used in memory
+/// and in a compiled dictionary image.
+struct ExactWordSlot {
+    ///@brief `HashExactWord` of the word.
+    uint64_t hash;
+
+    ///@brief The start of the word in the string pool, or `EmptyExactWordSlot`.
+    uint32_t position;
+
+    ///@brief The size of the word. `AmbiguousExactWord` is set if the word
+    /// has other case variants, or may have had them before a removal.
+    uint32_t size;
 };
 
-struct SpellCheckResultInternal {
-    std::vector<SpellSuggestion> suggestions;
+static_assert(sizeof(ExactWordSlot) == 16, "");
 
-    ///@brief `true` if the word is correctly spelled; `false` otherwise.
-    bool correctlySpelled;
+constexpr uint32_t EmptyExactWordSlot = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t AmbiguousExactWord = static_cast<uint32_t>(1) << 31;
+
+enum class CaseVariants {
+    None,
+    One,
+    Many,
 };
 
-void SpellCheckInternal(
-    const std::string& input,
-    const std::vector<std::string>& dictionary,
-    std::vector<SpellSuggestion> & suggestions,
-    bool & exactMatching,
-    std::size_t inputWordSize,
-    std::size_t & gapSizeThreshold,
-    double & similarityThreshold,
-    int distanceThreshold)
+uint64_t HashExactWord(StringView word)
 {
-    for (auto & word : dictionary) {
-        const auto gapSize = ComputeGapSize(StringLength(word), inputWordSize);
-        if (gapSize > gapSizeThreshold) {
-            continue;
-        }
-
-        const auto similarity = closestMatchFuzzySimilarity(input, word, distanceThreshold);
-        if (similarity == 1.0) {
-            // exaxt matching
-            SpellSuggestion suggestion;
-            suggestion.word = word;
-            suggestion.similarity = similarity;
-            suggestions.insert(std::begin(suggestions), std::move(suggestion));
-            exactMatching = true;
-            break;
-        }
-        else if (similarity >= similarityThreshold) {
-            similarityThreshold = std::max(similarity, similarityThreshold);
-            gapSizeThreshold = std::max<std::size_t>(gapSize, 1);
-            assert(similarityThreshold <= 1.0);
-            SpellSuggestion suggestion;
-            suggestion.word = word;
-            suggestion.similarity = similarity;
-            suggestions.push_back(std::move(suggestion));
-        }
+    // NOTE: 64-bit FNV-1a of the lower case word
+    uint64_t hash = 14695981039346656037ULL;
+    for (auto c : word) {
+        hash ^= static_cast<uint8_t>(ToLowerAscii(c));
+        hash *= 1099511628211ULL;
     }
+    return hash;
 }
 
-std::size_t ComputePrefixLength(const std::string& a, const std::string& b)
+std::size_t GetExactWordSlotCount(std::size_t wordCount)
 {
-    const auto minSize = std::min(a.size(), b.size());
-    std::size_t prefixLength = 0;
-    for (std::size_t i = 0; i < minSize; ++i) {
-        assert(i < a.size());
-        assert(i < b.size());
-        if (a[i] != b[i]) {
-            break;
-        }
-        ++prefixLength;
+    // NOTE: Keeps the load factor at or below 3/4 like `HashedDictionary`.
+    std::size_t slotCount = 16;
+    while (wordCount * 4 > slotCount * 3) {
+        slotCount *= 2;
     }
-    return prefixLength;
+    return slotCount;
 }
 
-std::size_t ComputeSurfixLength(const std::string& a, const std::string& b)
+StringView GetExactWord(const ExactWordSlot& slot, const char* stringPool)
 {
-    const auto minSize = std::min(a.size(), b.size());
-    std::size_t surfixLength = 0;
-    for (std::size_t i = 1; i <= minSize; ++i) {
-        assert(i <= a.size());
-        assert(i <= b.size());
-        if (a[a.size() - i] != b[b.size() - i]) {
-            break;
-        }
-        ++surfixLength;
-    }
-    return surfixLength;
+    assert(slot.position != EmptyExactWordSlot);
+    return StringView(stringPool + slot.position, slot.size & ~AmbiguousExactWord);
 }
 
-void SortSuggestions(const std::string& word, std::vector<SpellSuggestion>& suggestions)
+///@brief Returns the slot of the word that equals `word` ignoring case, or
+/// the empty slot to put it in. `slotCount` is a power of two.
+std::size_t FindExactWordSlot(
+    const ExactWordSlot* slots,
+    std::size_t slotCount,
+    const char* stringPool,
+    uint64_t hash,
+    StringView word)
 {
-    for (auto & suggestion : suggestions) {
-        if (!suggestion.similarity) {
-            suggestion.similarity = somera::closestMatchFuzzySimilarity(word, suggestion.word);
-        }
+    // NOTE:
+    // Linear probing like `HashedDictionary`. The full hash is kept in the
+    // slot, so the words are only compared on a likely match.
+    assert((slotCount & (slotCount - 1)) == 0);
+    const auto mask = slotCount - 1;
+    auto index = static_cast<std::size_t>(hash >> 32) & mask;
+    while ((slots[index].position != EmptyExactWordSlot)
+        && ((slots[index].hash != hash) || !EqualsIgnoringCase(GetExactWord(slots[index], stringPool), word))) {
+        index = (index + 1) & mask;
     }
+    return index;
+}
 
-    std::sort(std::begin(suggestions), std::end(suggestions), [&](const SpellSuggestion& a, const SpellSuggestion& b) {
-        assert(a.similarity);
-        assert(b.similarity);
-        if (*a.similarity != *b.similarity) {
-            return *a.similarity > *b.similarity;
-        }
-        const auto distanceA = somera::levenshteinDistance_DynamicProgramming_ReplacementCost1(word, a.word);
-        const auto distanceB = somera::levenshteinDistance_DynamicProgramming_ReplacementCost1(word, b.word);
-        if (distanceA != distanceB) {
-            return distanceA < distanceB;
-        }
-        const auto prefixA = ComputePrefixLength(word, a.word);
-        const auto prefixB = ComputePrefixLength(word, b.word);
-        if (prefixA != prefixB) {
-            return prefixA > prefixB;
-        }
-        const auto gapA = ComputeGapSize(word.size(), a.word.size());
-        const auto gapB = ComputeGapSize(word.size(), b.word.size());
-        if (gapA != gapB) {
-            return gapA < gapB;
-        }
-        const auto surfixA = ComputeSurfixLength(word, a.word);
-        const auto surfixB = ComputeSurfixLength(word, b.word);
-        return surfixA > surfixB;
-    });
+///@brief Adds the word at `position` of `stringPool`. The table must have
+/// room for it.
+void InsertExactWord(
+    ExactWordSlot* slots,
+    std::size_t slotCount,
+    const char* stringPool,
+    uint32_t position,
+    uint32_t size)
+{
+    assert(size < AmbiguousExactWord);
+    const StringView word(stringPool + position, size);
+    const auto hash = HashExactWord(word);
+    auto & slot = slots[FindExactWordSlot(slots, slotCount, stringPool, hash, word)];
+    if (slot.position == EmptyExactWordSlot) {
+        slot.hash = hash;
+        slot.position = position;
+        slot.size = size;
+    }
+    else if (GetExactWord(slot, stringPool) != word) {
+        // NOTE: Another case variant of the word, such as "Polish" and "polish".
+        slot.size |= AmbiguousExactWord;
+    }
 }
 
-SpellCheckResultInternal SpellCheck_SignatureHashinging_Internal(
-    const std::string& input,
-    const std::unordered_map<uint32_t, std::vector<std::string>>& hashedDictionary,
-    const std::function<uint32_t(const std::string&)>& histogramHashing,
-    const int maxHashLength,
-    const int distanceThreshold)
+CaseVariants FindCaseVariant(
+    const ExactWordSlot* slots,
+    std::size_t slotCount,
+    const char* stringPool,
+    StringView word,
+    StringView& variant)
 {
-    std::size_t gapSizeThreshold = 2;
+    if (slotCount == 0) {
+        return CaseVariants::None;
+    }
+    const auto& slot = slots[FindExactWordSlot(slots, slotCount, stringPool, HashExactWord(word), word)];
+    if (slot.position == EmptyExactWordSlot) {
+        return CaseVariants::None;
+    }
+    if ((slot.size & AmbiguousExactWord) != 0) {
+        return CaseVariants::Many;
+    }
+    variant = GetExactWord(slot, stringPool);
+    return CaseVariants::One;
+}
 
-    SpellCheckResultInternal result;
-    result.correctlySpelled = false;
+// NOTE:
+// The compiled dictionary image is laid out as follows:
+//
+//   CompiledDictionaryHeader
+//   uint64_t wordMasks[wordCount]           (see `ComputeCharacterMask`)
+//   ExactWordSlot[exactWordSlotCount]       (positions in the string pool)
+//   CompiledDictionaryBucket[bucketCount]   (sorted by signature)
+//   uint32_t wordOffsets[wordCount + 1]     (offsets into the string pool)
+//   char stringPool[stringPoolSize]
+//
+// Words are deduplicated and sorted within each bucket, and the buckets
+// are keyed by `SignatureHashingFromAsciiAlphabet`.
+constexpr char CompiledDictionaryMagic[8] = {'T', 'Y', 'P', 'O', 'D', 'I', 'C', 'T'};
+constexpr uint32_t CompiledDictionaryVersion = 3;
+
+struct CompiledDictionaryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t bucketCount;
+    uint32_t wordCount;
+    uint32_t exactWordSlotCount;
+    uint64_t stringPoolSize;
+};
 
-    const auto inputHistogramHashing = histogramHashing(input);
-    const auto inputWordSize = StringLength(input);
+struct CompiledDictionaryBucket {
+    uint32_t signature;
+    uint32_t firstWord;
+    uint32_t wordCount;
+};
 
-    const auto sizeAsDouble = static_cast<double>(inputWordSize);
-    double similarityThreshold = std::max((sizeAsDouble - std::min(sizeAsDouble, 2.0)) / sizeAsDouble, 0.5);
+static_assert(sizeof(CompiledDictionaryHeader) == 32, "");
+static_assert(sizeof(CompiledDictionaryBucket) == 12, "");
 
-    for (int i = 0; i <= maxHashLength; ++i) {
-        const uint32_t bitmask = ((static_cast<uint32_t>(1) << i) >> 1);
-        const uint32_t xorBits = inputHistogramHashing ^ bitmask;
+class CompiledDictionary final {
+public:
+    ///@brief Maps the image in the file at `path`.
+    std::error_code Open(const std::string& path);
 
-        auto iter = hashedDictionary.find(xorBits);
-        if (iter == std::end(hashedDictionary)) {
-            continue;
-        }
-        const auto& dictionary = iter->second;
+    ///@brief Takes an image built by `BuildCompiledDictionaryImage`.
+    std::error_code Assign(std::vector<char> && imageIn);
 
-        bool exactMatching = false;
+    Optional<WordBucket> FindBucket(uint32_t signature) const;
 
-        SpellCheckInternal(
-            input,
-            dictionary,
-            result.suggestions,
-            exactMatching,
-            inputWordSize,
-            gapSizeThreshold,
-            similarityThreshold,
-            distanceThreshold);
+    bool Contains(const std::string& word) const;
 
-        if (exactMatching) {
-            result.correctlySpelled = true;
-            break;
-        }
+    CaseVariants FindCaseVariant(StringView word, StringView& variant) const;
+
+private:
+    std::error_code Parse(const char* data, std::size_t size);
+
+private:
+    // NOTE: The image is either mapped from `file` or held in `image`.
+    MemoryMappedFile file;
+    std::vector<char> image;
+    const uint64_t* wordMasks = nullptr;
+    const ExactWordSlot* exactWordSlots = nullptr;
+    const CompiledDictionaryBucket* buckets = nullptr;
+    const uint32_t* wordOffsets = nullptr;
+    const char* stringPool = nullptr;
+    uint32_t bucketCount = 0;
+    uint32_t exactWordSlotCount = 0;
+};
+
+std::error_code CompiledDictionary::Open(const std::string& path)
+{
+    if (auto errorCode = file.Open(path)) {
+        return errorCode;
     }
-    return result;
+    return Parse(file.GetData(), file.GetSize());
 }
 
-Optional<SpellSuggestion> ExistWordSignatureHashingingInternal(
-    const std::string& input,
-    const std::unordered_map<uint32_t, std::vector<std::string>>& hashedDictionary)
+std::error_code CompiledDictionary::Assign(std::vector<char> && imageIn)
 {
-    std::size_t gapSizeThreshold = 1;
-    const int distanceThreshold = 1;
-
-    SpellCheckResultInternal result;
-    result.correctlySpelled = false;
+    // NOTE: `operator new` aligns the buffer enough for the 8-byte arrays.
+    image = std::move(imageIn);
+    return Parse(image.data(), image.size());
+}
 
-    const auto inputWordSize = StringLength(input);
+std::error_code CompiledDictionary::Parse(const char* data, std::size_t size)
+{
+    const auto invalidImage = std::make_error_code(std::errc::invalid_argument);
+    if (size < sizeof(CompiledDictionaryHeader)) {
+        return invalidImage;
+    }
 
-    double similarityThreshold = 0.8;
+    CompiledDictionaryHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if ((std::memcmp(header.magic, CompiledDictionaryMagic, sizeof(header.magic)) != 0)
+        || (header.version != CompiledDictionaryVersion)) {
+        return invalidImage;
+    }
 
-    const auto histogramHashing = SignatureHashingFromAsciiAlphabet;
-    const auto inputHistogramHashing = histogramHashing(input);
+    // NOTE: The probing ends at an empty slot, so there has to be one.
+    const auto slotCount = header.exactWordSlotCount;
+    if (((slotCount & (slotCount - 1)) != 0) || (slotCount <= header.wordCount)) {
+        return invalidImage;
+    }
 
-    auto iter = hashedDictionary.find(inputHistogramHashing);
-    if (iter == std::end(hashedDictionary)) {
-        return NullOpt;
+    const auto wordMasksOffset = sizeof(CompiledDictionaryHeader);
+    const auto exactWordSlotsOffset = wordMasksOffset + sizeof(uint64_t) * static_cast<uint64_t>(header.wordCount);
+    const auto bucketsOffset = exactWordSlotsOffset + sizeof(ExactWordSlot) * static_cast<uint64_t>(slotCount);
+    const auto wordOffsetsOffset = bucketsOffset + sizeof(CompiledDictionaryBucket) * header.bucketCount;
+    const auto stringPoolOffset = wordOffsetsOffset + sizeof(uint32_t) * (static_cast<uint64_t>(header.wordCount) + 1);
+    if ((stringPoolOffset > size) || (header.stringPoolSize != size - stringPoolOffset)) {
+        return invalidImage;
     }
-    const auto& dictionary = iter->second;
 
-    Optional<SpellSuggestion> currentSuggestion;
+    wordMasks = reinterpret_cast<const uint64_t*>(data + wordMasksOffset);
+    exactWordSlots = reinterpret_cast<const ExactWordSlot*>(data + exactWordSlotsOffset);
+    buckets = reinterpret_cast<const CompiledDictionaryBucket*>(data + bucketsOffset);
+    wordOffsets = reinterpret_cast<const uint32_t*>(data + wordOffsetsOffset);
+    stringPool = data + stringPoolOffset;
+    bucketCount = header.bucketCount;
+    exactWordSlotCount = slotCount;
 
-    for (auto & word : dictionary) {
-        const auto gapSize = ComputeGapSize(StringLength(word), inputWordSize);
-        if (gapSize > gapSizeThreshold) {
-            continue;
+    // NOTE:
+    // The lookups trust the offsets and positions in the image, so a broken
+    // or hostile image is rejected here instead of reading out of bounds.
+    if ((wordOffsets[0] != 0) || (wordOffsets[header.wordCount] != header.stringPoolSize)) {
+        return invalidImage;
+    }
+    for (uint32_t i = 0; i < header.wordCount; ++i) {
+        if (wordOffsets[i] > wordOffsets[i + 1]) {
+            return invalidImage;
         }
-
-        const auto similarity = closestMatchFuzzySimilarity(input, word, distanceThreshold);
-        if (similarity == 1.0) {
-            // exaxt matching
-            SpellSuggestion suggestion;
-            suggestion.word = word;
-            suggestion.similarity = similarity;
-            return suggestion;
+    }
+    for (uint32_t i = 0; i < bucketCount; ++i) {
+        const auto& bucket = buckets[i];
+        if ((static_cast<uint64_t>(bucket.firstWord) + bucket.wordCount > header.wordCount)
+            || ((i > 0) && (buckets[i - 1].signature >= bucket.signature))) {
+            return invalidImage;
         }
-        else if (similarity >= similarityThreshold) {
-            similarityThreshold = std::max(similarity, similarityThreshold);
-            gapSizeThreshold = std::max<std::size_t>(gapSize, 1);
-            assert(similarityThreshold <= 1.0);
-            SpellSuggestion suggestion;
-            suggestion.word = word;
-            suggestion.similarity = similarity;
-            currentSuggestion = std::move(suggestion);
+    }
+    bool hasEmptySlot = false;
+    for (uint32_t i = 0; i < slotCount; ++i) {
+        const auto& slot = exactWordSlots[i];
+        if (slot.position == EmptyExactWordSlot) {
+            hasEmptySlot = true;
+        }
+        else if (static_cast<uint64_t>(slot.position) + (slot.size & ~AmbiguousExactWord) > header.stringPoolSize) {
+            return invalidImage;
         }
     }
-    return currentSuggestion;
+    if (!hasEmptySlot) {
+        return invalidImage;
+    }
+    return {};
 }
 
-SpellCheckResultInternal SuggestInternal(
-    const std::string& word,
-    const std::unordered_map<uint32_t, std::vector<std::string>>& hashedDictionary)
+Optional<WordBucket> CompiledDictionary::FindBucket(uint32_t signature) const
 {
-    const auto distanceThreshold = std::min(static_cast<int>(word.size()), 10);
-    return SpellCheck_SignatureHashinging_Internal(
-        word,
-        hashedDictionary,
-        SignatureHashingFromAsciiAlphabet,
-        28,
-        distanceThreshold);
+    auto bucket = std::lower_bound(buckets, buckets + bucketCount, signature,
+        [](const CompiledDictionaryBucket& a, uint32_t b) { return a.signature < b; });
+    if ((bucket == buckets + bucketCount) || (bucket->signature != signature)) {
+        return NullOpt;
+    }
+    WordBucket words;
+    words.offsets = wordOffsets + bucket->firstWord;
+    words.masks = wordMasks + bucket->firstWord;
+    words.stringPool = stringPool;
+    words.wordCount = bucket->wordCount;
+    return words;
 }
 
-enum class LetterCase {
-    LowerCase,
-    UpperCase,
-    UpperCamelCase,
-};
+bool CompiledDictionary::Contains(const std::string& word) const
+{
+    auto bucket = FindBucket(SignatureHashingFromAsciiAlphabet(word));
+    return bucket && ContainsWord(*bucket, word);
+}
 
-LetterCase GetLetterCase(const std::string& word)
+CaseVariants CompiledDictionary::FindCaseVariant(StringView word, StringView& variant) const
 {
-    ///@todo This function doesn't support UTF-8 string.
-    bool isLowerCase = true;
-    bool isUpperCase = true;
-    bool isUpperCamelCase = true;
-    if (word.empty() || (::isupper(word.front()) == 0)) {
-        isUpperCamelCase = false;
+    return somera::FindCaseVariant(exactWordSlots, exactWordSlotCount, stringPool, word, variant);
+}
+
+template <class T>
+void AppendToImage(std::vector<char> & image, const std::vector<T>& elements)
+{
+    const auto data = reinterpret_cast<const char*>(elements.data());
+    image.insert(std::end(image), data, data + sizeof(T) * elements.size());
+}
+
+std::error_code BuildCompiledDictionaryImage(
+    const std::vector<std::string>& words, std::vector<char> & image)
+{
+    // NOTE:
+    // Sorts the indices of the words by signature and then by word, the
+    // order of the words in the image, so that no word is copied.
+    assert(words.size() <= std::numeric_limits<uint32_t>::max());
+    std::vector<uint64_t> keys;
+    keys.reserve(words.size());
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        if (!words[i].empty()) {
+            const uint64_t signature = SignatureHashingFromAsciiAlphabet(words[i]);
+            keys.push_back((signature << 32) | static_cast<uint32_t>(i));
+        }
     }
-    for (auto c : word) {
-        if (::islower(c) != 0) {
-            isUpperCase = false;
+    auto wordOf = [&](uint64_t key) -> const std::string& {
+        return words[static_cast<uint32_t>(key)];
+    };
+    std::sort(std::begin(keys), std::end(keys), [&](uint64_t a, uint64_t b) {
+        if ((a >> 32) != (b >> 32)) {
+            return (a >> 32) < (b >> 32);
         }
-        if (::isupper(c) != 0) {
-            isLowerCase = false;
+        return wordOf(a) < wordOf(b);
+    });
+    keys.erase(
+        std::unique(std::begin(keys), std::end(keys), [&](uint64_t a, uint64_t b) {
+            return wordOf(a) == wordOf(b);
+        }),
+        std::end(keys));
+
+    std::vector<CompiledDictionaryBucket> compiledBuckets;
+    std::vector<uint64_t> wordMasks;
+    std::vector<uint32_t> wordOffsets;
+    std::string stringPool;
+    wordMasks.reserve(keys.size());
+    wordOffsets.reserve(keys.size() + 1);
+
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        const auto signature = static_cast<uint32_t>(keys[i] >> 32);
+        if (compiledBuckets.empty() || (compiledBuckets.back().signature != signature)) {
+            CompiledDictionaryBucket bucket;
+            bucket.signature = signature;
+            bucket.firstWord = static_cast<uint32_t>(wordOffsets.size());
+            bucket.wordCount = 0;
+            compiledBuckets.push_back(bucket);
         }
+        ++compiledBuckets.back().wordCount;
+
+        auto & word = wordOf(keys[i]);
+        if (stringPool.size() + word.size() > std::numeric_limits<uint32_t>::max()) {
+            return std::make_error_code(std::errc::file_too_large);
+        }
+        wordMasks.push_back(ComputeCharacterMask(word.data(), word.size()));
+        wordOffsets.push_back(static_cast<uint32_t>(stringPool.size()));
+        stringPool += word;
     }
-    if (isLowerCase) {
-        return LetterCase::LowerCase;
-    }
-    else if (isUpperCase) {
-        return LetterCase::UpperCase;
+
+    std::vector<ExactWordSlot> exactWordSlots(
+        GetExactWordSlotCount(wordOffsets.size()),
+        ExactWordSlot{0, EmptyExactWordSlot, 0});
+    for (std::size_t i = 0; i < wordOffsets.size(); ++i) {
+        const auto end = (i + 1 < wordOffsets.size()) ? wordOffsets[i + 1] : stringPool.size();
+        InsertExactWord(
+            exactWordSlots.data(),
+            exactWordSlots.size(),
+            stringPool.data(),
+            wordOffsets[i],
+            static_cast<uint32_t>(end - wordOffsets[i]));
     }
-    else if (isUpperCamelCase) {
-        return LetterCase::UpperCamelCase;
+
+    CompiledDictionaryHeader header;
+    std::memcpy(header.magic, CompiledDictionaryMagic, sizeof(header.magic));
+    header.version = CompiledDictionaryVersion;
+    header.bucketCount = static_cast<uint32_t>(compiledBuckets.size());
+    header.wordCount = static_cast<uint32_t>(wordOffsets.size());
+    header.exactWordSlotCount = static_cast<uint32_t>(exactWordSlots.size());
+    header.stringPoolSize = stringPool.size();
+    wordOffsets.push_back(static_cast<uint32_t>(stringPool.size()));
+
+    image.clear();
+    image.reserve(sizeof(header)
+        + sizeof(uint64_t) * wordMasks.size()
+        + sizeof(ExactWordSlot) * exactWordSlots.size()
+        + sizeof(CompiledDictionaryBucket) * compiledBuckets.size()
+        + sizeof(uint32_t) * wordOffsets.size()
+        + stringPool.size());
+    const auto headerData = reinterpret_cast<const char*>(&header);
+    image.insert(std::end(image), headerData, headerData + sizeof(header));
+    AppendToImage(image, wordMasks);
+    AppendToImage(image, exactWordSlots);
+    AppendToImage(image, compiledBuckets);
+    AppendToImage(image, wordOffsets);
+    image.insert(std::end(image), std::begin(stringPool), std::end(stringPool));
+    return {};
+}
+
+///@brief The in-memory buckets of the signature hashing engine, stored in
+/// one arena and indexed by an open-addressing table keyed on the signature.
+class HashedDictionary final {
+public:
+    Optional<WordBucket> FindBucket(uint32_t signature) const;
+
+    void Erase(uint32_t signature, const std::string& word);
+
+    ///@brief Adds many words that share `signature` with a single rebuild of the bucket.
+    void Merge(uint32_t signature, std::vector<StringView> && words);
+
+    ///@brief Makes room for `newBucketCount` more buckets and `newArenaSize`
+    /// more 8-byte words of arena.
+    void Reserve(std::size_t newBucketCount, std::size_t newArenaSize);
+
+private:
+    struct Slot {
+        uint32_t signature;
+
+        ///@brief The start of the bucket in `arena`, or `EmptySlot`.
+        uint32_t position;
+    };
+
+    static constexpr uint32_t EmptySlot = std::numeric_limits<uint32_t>::max();
+
+    std::size_t FindSlot(uint32_t signature) const;
+
+    void Assign(uint32_t signature, const std::vector<StringView>& sortedWords);
+
+    void Rehash(std::size_t slotCount);
+
+    void Compact();
+
+private:
+    // NOTE:
+    // Each bucket is a block of `arena` laid out as follows:
+    //
+    //   uint64_t wordCount
+    //   uint64_t masks[wordCount]
+    //   uint32_t offsets[wordCount + 1]
+    //   char stringPool[offsets[wordCount]]   (padded to 8 bytes)
+    //
+    // A bucket that changes is appended again at the end, and the old block
+    // stays as garbage until `Compact`. There is no heap node per bucket
+    // and no heap string per word.
+    std::vector<uint64_t> arena;
+    std::vector<Slot> slots;
+    std::size_t bucketCount = 0;
+    std::size_t garbageSize = 0;
+};
+
+constexpr uint32_t HashedDictionary::EmptySlot;
+
+WordBucket ReadWordBucket(const uint64_t* block)
+{
+    WordBucket words;
+    words.wordCount = static_cast<uint32_t>(block[0]);
+    words.masks = block + 1;
+    words.offsets = reinterpret_cast<const uint32_t*>(words.masks + words.wordCount);
+    words.stringPool = reinterpret_cast<const char*>(words.offsets + words.wordCount + 1);
+    return words;
+}
+
+std::size_t GetWordBucketBlockSize(uint32_t wordCount, std::size_t stringPoolSize)
+{
+    const auto byteCount = sizeof(uint64_t) * (1 + wordCount)
+        + sizeof(uint32_t) * (wordCount + 1)
+        + stringPoolSize;
+    return (byteCount + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+}
+
+std::size_t GetWordBucketBlockSize(const uint64_t* block)
+{
+    const auto words = ReadWordBucket(block);
+    return GetWordBucketBlockSize(words.wordCount, words.offsets[words.wordCount]);
+}
+
+void WriteWordBucket(const std::vector<StringView>& sortedWords, std::vector<uint64_t> & block)
+{
+    assert(std::is_sorted(std::begin(sortedWords), std::end(sortedWords)));
+    std::size_t stringPoolSize = 0;
+    for (auto & word : sortedWords) {
+        stringPoolSize += word.size();
+    }
+    assert(stringPoolSize <= std::numeric_limits<uint32_t>::max());
+
+    const auto count = static_cast<uint32_t>(sortedWords.size());
+    block.assign(GetWordBucketBlockSize(count, stringPoolSize), 0);
+    block[0] = count;
+
+    auto masks = block.data() + 1;
+    auto offsets = reinterpret_cast<uint32_t*>(masks + count);
+    auto stringPool = reinterpret_cast<char*>(offsets + count + 1);
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        auto & word = sortedWords[i];
+        masks[i] = ComputeCharacterMask(word.data(), word.size());
+        offsets[i] = offset;
+        if (!word.empty()) {
+            std::memcpy(stringPool + offset, word.data(), word.size());
+        }
+        offset += static_cast<uint32_t>(word.size());
+    }
+    offsets[count] = offset;
+}
+
+std::size_t HashedDictionary::FindSlot(uint32_t signature) const
+{
+    // NOTE: Fibonacci hashing with linear probing. `slots.size()` is a power of two.
+    assert(!slots.empty());
+    const auto mask = slots.size() - 1;
+    auto index = static_cast<std::size_t>((signature * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+    while ((slots[index].position != EmptySlot) && (slots[index].signature != signature)) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+Optional<WordBucket> HashedDictionary::FindBucket(uint32_t signature) const
+{
+    if (slots.empty()) {
+        return NullOpt;
+    }
+    const auto& slot = slots[FindSlot(signature)];
+    if (slot.position == EmptySlot) {
+        return NullOpt;
+    }
+    return ReadWordBucket(arena.data() + slot.position);
+}
+
+void HashedDictionary::Rehash(std::size_t slotCount)
+{
+    assert((slotCount & (slotCount - 1)) == 0);
+    assert(slotCount > bucketCount);
+    auto oldSlots = std::move(slots);
+    slots.assign(slotCount, Slot{0, EmptySlot});
+    for (auto & slot : oldSlots) {
+        if (slot.position != EmptySlot) {
+            slots[FindSlot(slot.signature)] = slot;
+        }
+    }
+}
+
+void HashedDictionary::Reserve(std::size_t newBucketCount, std::size_t newArenaSize)
+{
+    // NOTE: Keeps the load factor at or below 3/4.
+    std::size_t slotCount = std::max<std::size_t>(slots.size(), 16);
+    while ((bucketCount + newBucketCount) * 4 > slotCount * 3) {
+        slotCount *= 2;
+    }
+    if (slotCount != slots.size()) {
+        Rehash(slotCount);
+    }
+    arena.reserve(arena.size() + newArenaSize);
+}
+
+void HashedDictionary::Compact()
+{
+    std::vector<uint64_t> newArena;
+    newArena.reserve(arena.size() - garbageSize);
+    for (auto & slot : slots) {
+        if (slot.position == EmptySlot) {
+            continue;
+        }
+        const auto block = arena.data() + slot.position;
+        const auto blockSize = GetWordBucketBlockSize(block);
+        slot.position = static_cast<uint32_t>(newArena.size());
+        newArena.insert(std::end(newArena), block, block + blockSize);
+    }
+    std::swap(arena, newArena);
+    garbageSize = 0;
+}
+
+void HashedDictionary::Assign(uint32_t signature, const std::vector<StringView>& sortedWords)
+{
+    // NOTE: `sortedWords` may point into the arena, so the block is written out first.
+    std::vector<uint64_t> block;
+    WriteWordBucket(sortedWords, block);
+
+    Reserve(1, 0);
+    auto & slot = slots[FindSlot(signature)];
+    if (slot.position == EmptySlot) {
+        slot.signature = signature;
+        ++bucketCount;
+    }
+    else {
+        garbageSize += GetWordBucketBlockSize(arena.data() + slot.position);
+    }
+
+    assert(arena.size() + block.size() <= EmptySlot);
+    slot.position = static_cast<uint32_t>(arena.size());
+    arena.insert(std::end(arena), std::begin(block), std::end(block));
+
+    if ((garbageSize > 4096) && (garbageSize * 4 > arena.size())) {
+        Compact();
+    }
+}
+
+void HashedDictionary::Erase(uint32_t signature, const std::string& word)
+{
+    const auto words = FindBucket(signature);
+    if (!words) {
+        return;
+    }
+    const auto index = LowerBound(*words, word);
+    if ((index >= words->wordCount) || (GetWord(*words, index) != word)) {
+        return;
+    }
+
+    std::vector<StringView> sortedWords;
+    sortedWords.reserve(words->wordCount - 1);
+    for (uint32_t i = 0; i < words->wordCount; ++i) {
+        if (i != index) {
+            sortedWords.push_back(GetWord(*words, i));
+        }
+    }
+    Assign(signature, sortedWords);
+}
+
+void HashedDictionary::Merge(uint32_t signature, std::vector<StringView> && words)
+{
+    if (const auto oldWords = FindBucket(signature)) {
+        words.reserve(words.size() + oldWords->wordCount);
+        for (uint32_t i = 0; i < oldWords->wordCount; ++i) {
+            words.push_back(GetWord(*oldWords, i));
+        }
+    }
+    std::sort(std::begin(words), std::end(words));
+    words.erase(std::unique(std::begin(words), std::end(words)), std::end(words));
+    Assign(signature, words);
+}
+
+///@brief The in-memory counterpart of the exact word slots of a compiled
+/// dictionary, for the words added at runtime.
+class ExactWordIndex final {
+public:
+    CaseVariants FindCaseVariant(StringView word, StringView& variant) const;
+
+    void Insert(StringView word);
+
+    ///@brief Makes `FindCaseVariant` give up on the words that equal `word`
+    /// ignoring case. The table can't tell which case variants are left.
+    void Invalidate(StringView word);
+
+    ///@brief Makes room for `newWordCount` more words.
+    void Reserve(std::size_t newWordCount);
+
+private:
+    std::vector<ExactWordSlot> slots;
+    std::string stringPool;
+    std::size_t wordCount = 0;
+};
+
+CaseVariants ExactWordIndex::FindCaseVariant(StringView word, StringView& variant) const
+{
+    return somera::FindCaseVariant(slots.data(), slots.size(), stringPool.data(), word, variant);
+}
+
+void ExactWordIndex::Reserve(std::size_t newWordCount)
+{
+    const auto slotCount = GetExactWordSlotCount(wordCount + newWordCount);
+    if (slotCount <= slots.size()) {
+        return;
+    }
+    auto oldSlots = std::move(slots);
+    slots.assign(slotCount, ExactWordSlot{0, EmptyExactWordSlot, 0});
+    const auto mask = slotCount - 1;
+    for (auto & slot : oldSlots) {
+        if (slot.position == EmptyExactWordSlot) {
+            continue;
+        }
+        // NOTE: The words are unique, so each one goes to the first empty slot.
+        auto index = static_cast<std::size_t>(slot.hash >> 32) & mask;
+        while (slots[index].position != EmptyExactWordSlot) {
+            index = (index + 1) & mask;
+        }
+        slots[index] = slot;
+    }
+}
+
+void ExactWordIndex::Insert(StringView word)
+{
+    Reserve(1);
+    const auto hash = HashExactWord(word);
+    auto & slot = slots[FindExactWordSlot(slots.data(), slots.size(), stringPool.data(), hash, word)];
+    if (slot.position != EmptyExactWordSlot) {
+        if (GetExactWord(slot, stringPool.data()) != word) {
+            // NOTE: Another case variant of the word, such as "Polish" and "polish".
+            slot.size |= AmbiguousExactWord;
+        }
+        return;
+    }
+    assert(stringPool.size() + word.size() < EmptyExactWordSlot);
+    assert(word.size() < AmbiguousExactWord);
+    slot.hash = hash;
+    slot.position = static_cast<uint32_t>(stringPool.size());
+    slot.size = static_cast<uint32_t>(word.size());
+    stringPool.append(word.data(), word.size());
+    ++wordCount;
+}
+
+void ExactWordIndex::Invalidate(StringView word)
+{
+    if (slots.empty()) {
+        return;
+    }
+    auto & slot = slots[FindExactWordSlot(
+        slots.data(), slots.size(), stringPool.data(), HashExactWord(word), word)];
+    if (slot.position != EmptyExactWordSlot) {
+        slot.size |= AmbiguousExactWord;
+    }
+}
+
+struct SignatureHashingDictionary {
+    const HashedDictionary& hashedDictionary;
+    const CompiledDictionary* compiledDictionary;
+
+    ///@brief Finds the words of `hashedDictionary` ignoring case.
+    const ExactWordIndex& exactWords;
+
+    ///@brief Words removed from the compiled dictionary, which is read-only.
+    const std::unordered_set<std::string>& removedWords;
+
+    ///@brief Collects the counters unless it is `nullptr`.
+    SpellCheckerStats* stats;
+};
+
+SpellCheckerStats* GetStats(const SignatureHashingDictionary& dictionary)
+{
+    return dictionary.stats;
+}
+
+void CountBucketLookup(const SignatureHashingDictionary& dictionary, const Optional<WordBucket>& words)
+{
+    if (dictionary.stats == nullptr) {
+        return;
+    }
+    ++dictionary.stats->bucketLookupCount;
+    if (words) {
+        ++dictionary.stats->bucketHitCount;
+        dictionary.stats->candidateCount += words->wordCount;
+    }
+}
+
+///@brief Adds the time until destruction to a member of `stats`, unless
+/// `stats` is `nullptr`.
+class StageTimer final {
+public:
+    StageTimer(SpellCheckerStats* statsIn, double SpellCheckerStats::* secondsIn)
+        : stats(statsIn)
+        , seconds(secondsIn)
+    {
+        if (stats != nullptr) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+    ~StageTimer()
+    {
+        if (stats != nullptr) {
+            const auto duration = std::chrono::steady_clock::now() - start;
+            stats->*seconds += std::chrono::duration<double>(duration).count();
+        }
+    }
+
+private:
+    SpellCheckerStats* stats;
+    double SpellCheckerStats::* seconds;
+    std::chrono::steady_clock::time_point start;
+};
+
+///@brief Words to add to and remove from a dictionary in one update.
+struct WordChanges {
+    std::vector<std::string> addedWords;
+    std::vector<std::string> removedWords;
+};
+
+///@brief Publishes immutable versions of a dictionary (read-copy-update).
+///
+/// Readers take the current snapshot without waiting for writers, and
+/// keep it alive for as long as they use it. A writer copies the snapshot,
+/// applies its changes, and swaps the copy in before it returns. A
+/// snapshot is freed when its last reader drops it.
+template <class Dictionary>
+class DictionarySnapshots final {
+public:
+    using ApplyFunction = std::function<void(Dictionary&, const std::vector<WordChanges>&)>;
+
+    explicit DictionarySnapshots(ApplyFunction applyIn)
+        : snapshot(std::make_shared<const Dictionary>())
+        , apply(std::move(applyIn))
+    {
+        assert(apply);
+    }
+
+    DictionarySnapshots(const DictionarySnapshots&) = delete;
+    DictionarySnapshots& operator=(const DictionarySnapshots&) = delete;
+
+    std::shared_ptr<const Dictionary> Acquire() const
+    {
+        return std::atomic_load(&snapshot);
+    }
+
+    ///@brief Publishes a snapshot with `changes` applied.
+    void Update(WordChanges&& changes)
+    {
+        {
+            std::lock_guard<std::mutex> pendingLock(pendingMutex);
+            pendingChanges.push_back(std::move(changes));
+        }
+
+        // NOTE:
+        // The writer that takes the lock applies every change queued so far
+        // to one copy, so concurrent writers share a single copy instead of
+        // making one each. A writer whose changes were published while it
+        // waited has nothing left to do.
+        std::lock_guard<std::mutex> lock(updateMutex);
+        std::vector<WordChanges> queuedChanges;
+        {
+            std::lock_guard<std::mutex> pendingLock(pendingMutex);
+            std::swap(queuedChanges, pendingChanges);
+        }
+        if (queuedChanges.empty()) {
+            return;
+        }
+        auto dictionary = std::make_shared<Dictionary>(*snapshot);
+        apply(*dictionary, queuedChanges);
+        std::atomic_store(&snapshot, std::shared_ptr<const Dictionary>(std::move(dictionary)));
+    }
+
+private:
+    // NOTE: Only `Update` replaces the snapshot, so it can read it directly
+    // while it holds `updateMutex`.
+    std::shared_ptr<const Dictionary> snapshot;
+    ApplyFunction apply;
+    std::mutex updateMutex;
+
+    std::mutex pendingMutex;
+    std::vector<WordChanges> pendingChanges;
+};
+
+bool IsRemovedWord(const SignatureHashingDictionary& dictionary, const std::string& word)
+{
+    return !dictionary.removedWords.empty() && (dictionary.removedWords.count(word) > 0);
+}
+
+///@brief The words added to and removed from a spell checker on top of
+/// its compiled dictionary.
+struct SignatureHashingLayer {
+    HashedDictionary hashedDictionary;
+    ExactWordIndex exactWords;
+
+    ///@brief Words removed from the compiled dictionary, which is read-only.
+    std::unordered_set<std::string> removedWords;
+};
+
+class SpellCheckerSignatureHashing final : public SpellChecker {
+public:
+    SpellCheckerSignatureHashing();
+
+    explicit SpellCheckerSignatureHashing(
+        const std::shared_ptr<const CompiledDictionary>& compiledDictionary);
+
+    SpellCheckResult Suggest(const std::string& word);
+
+    std::vector<SpellCheckResult> SuggestWords(
+        const std::vector<std::string>& words, int threadCount);
+
+    void AddWord(const std::string& word);
+
+    void AddWords(const std::vector<std::string>& words);
+
+    void RemoveWord(const std::string& word);
+
+    void UpdateWords(
+        const std::vector<std::string>& addedWords,
+        const std::vector<std::string>& removedWords);
+
+    void SetStatsEnabled(bool enabled);
+
+    SpellCheckerStats GetStats() const;
+
+private:
+    void ApplyChanges(const std::vector<WordChanges>& changes, SignatureHashingLayer& layer) const;
+
+    void AddWordsToLayer(const std::vector<std::string>& words, SignatureHashingLayer& layer) const;
+
+    void RemoveWordFromLayer(const std::string& word, SignatureHashingLayer& layer) const;
+
+    SignatureHashingDictionary MakeDictionary(
+        const SignatureHashingLayer& layer, SpellCheckerStats* localStats) const;
+
+    void MergeStats(const SpellCheckerStats& localStats);
+
+    std::shared_ptr<const CompiledDictionary> compiledDictionary;
+    DictionarySnapshots<SignatureHashingLayer> layers;
+
+    // NOTE: Each query collects its own stats and merges them at the end,
+    // so the threads of `SuggestWords` don't contend while checking.
+    mutable std::mutex statsMutex;
+    SpellCheckerStats stats;
+    bool isStatsEnabled = false;
+};
+
+SpellCheckerSignatureHashing::SpellCheckerSignatureHashing()
+    : SpellCheckerSignatureHashing(nullptr)
+{
+}
+
+SpellCheckerSignatureHashing::SpellCheckerSignatureHashing(
+    const std::shared_ptr<const CompiledDictionary>& compiledDictionaryIn)
+    : compiledDictionary(compiledDictionaryIn)
+    , layers([this](SignatureHashingLayer& layer, const std::vector<WordChanges>& changes) {
+        ApplyChanges(changes, layer);
+    })
+{
+}
+
+void SpellCheckerSignatureHashing::AddWord(const std::string& word)
+{
+    assert(!word.empty());
+    UpdateWords({word}, {});
+}
+
+void SpellCheckerSignatureHashing::AddWords(const std::vector<std::string>& words)
+{
+    UpdateWords(words, {});
+}
+
+void SpellCheckerSignatureHashing::RemoveWord(const std::string& word)
+{
+    UpdateWords({}, {word});
+}
+
+void SpellCheckerSignatureHashing::UpdateWords(
+    const std::vector<std::string>& addedWords,
+    const std::vector<std::string>& removedWords)
+{
+    layers.Update(WordChanges{addedWords, removedWords});
+}
+
+void SpellCheckerSignatureHashing::ApplyChanges(
+    const std::vector<WordChanges>& changes, SignatureHashingLayer& layer) const
+{
+    for (auto & change : changes) {
+        AddWordsToLayer(change.addedWords, layer);
+        for (auto & word : change.removedWords) {
+            RemoveWordFromLayer(word, layer);
+        }
+    }
+}
+
+void SpellCheckerSignatureHashing::AddWordsToLayer(
+    const std::vector<std::string>& words, SignatureHashingLayer& layer) const
+{
+    // NOTE:
+    // Groups the words by signature first so that each bucket is looked up
+    // and rebuilt only once. Inserting into sorted arrays one by one is
+    // O(n^2) per bucket.
+    assert(words.size() <= std::numeric_limits<uint32_t>::max());
+    std::vector<uint64_t> keys;
+    keys.reserve(words.size());
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        auto & word = words[i];
+        assert(!word.empty());
+
+        if (compiledDictionary && compiledDictionary->Contains(word)) {
+            layer.removedWords.erase(word);
+            continue;
+        }
+        const uint64_t signatureHash = SignatureHashingFromAsciiAlphabet(word);
+        keys.push_back((signatureHash << 32) | static_cast<uint32_t>(i));
+    }
+    std::sort(std::begin(keys), std::end(keys));
+
+    layer.exactWords.Reserve(keys.size());
+    for (auto key : keys) {
+        layer.exactWords.Insert(words[static_cast<uint32_t>(key)]);
+    }
+
+    std::size_t newBucketCount = 0;
+    std::size_t arenaSize = 0;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        if ((i == 0) || ((keys[i] >> 32) != (keys[i - 1] >> 32))) {
+            ++newBucketCount;
+            arenaSize += 2;
+        }
+        arenaSize += 2 + words[static_cast<uint32_t>(keys[i])].size() / sizeof(uint64_t);
+    }
+    layer.hashedDictionary.Reserve(newBucketCount, arenaSize);
+
+    auto first = std::begin(keys);
+    while (first != std::end(keys)) {
+        const auto signatureHash = static_cast<uint32_t>(*first >> 32);
+        auto last = std::find_if(first, std::end(keys), [&](uint64_t key) {
+            return static_cast<uint32_t>(key >> 32) != signatureHash;
+        });
+
+        std::vector<StringView> bucketWords;
+        bucketWords.reserve(std::distance(first, last));
+        for (; first != last; ++first) {
+            bucketWords.push_back(words[static_cast<uint32_t>(*first)]);
+        }
+        layer.hashedDictionary.Merge(signatureHash, std::move(bucketWords));
+    }
+}
+
+void SpellCheckerSignatureHashing::RemoveWordFromLayer(
+    const std::string& word, SignatureHashingLayer& layer) const
+{
+    layer.exactWords.Invalidate(word);
+
+    if (compiledDictionary && compiledDictionary->Contains(word)) {
+        layer.removedWords.insert(word);
+        return;
+    }
+
+    auto signatureHash = SignatureHashingFromAsciiAlphabet(word);
+    layer.hashedDictionary.Erase(signatureHash, word);
+}
+
+SignatureHashingDictionary SpellCheckerSignatureHashing::MakeDictionary(
+    const SignatureHashingLayer& layer, SpellCheckerStats* localStats) const
+{
+    return {
+        layer.hashedDictionary,
+        compiledDictionary.get(),
+        layer.exactWords,
+        layer.removedWords,
+        localStats,
+    };
+}
+
+size_t StringLength(const std::string& s)
+{
+    // TODO: This function is not supported UTF-8 strings.
+    return s.size();
+}
+
+size_t ComputeGapSize(size_t a, size_t b)
+{
+    if (a > b) {
+        assert((a - b) <= a);
+        return a - b;
+    }
+    assert((b - a) <= b);
+    return b - a;
+}
+
+struct SpellSuggestion {
+    std::string word;
+    Optional<double> similarity;
+};
+
+struct SpellCheckResultInternal {
+    std::vector<SpellSuggestion> suggestions;
+
+    ///@brief `true` if the word is correctly spelled; `false` otherwise.
+    bool correctlySpelled;
+};
+
+// NOTE: Returns `true` on exact matching.
+bool SpellCheckCandidate(
+    const std::string& input,
+    const std::string& word,
+    std::size_t gapSize,
+    const SignatureHashingDictionary& signatureDictionary,
+    std::vector<SpellSuggestion> & suggestions,
+    std::size_t & gapSizeThreshold,
+    double & similarityThreshold,
+    int distanceThreshold)
+{
+    const auto similarity = closestMatchFuzzySimilarity(input, word, distanceThreshold, similarityThreshold);
+    if ((similarity >= similarityThreshold) && IsRemovedWord(signatureDictionary, word)) {
+        return false;
+    }
+    if (similarity == 1.0) {
+        // exaxt matching
+        SpellSuggestion suggestion;
+        suggestion.word = word;
+        suggestion.similarity = similarity;
+        suggestions.insert(std::begin(suggestions), std::move(suggestion));
+        return true;
+    }
+    else if (similarity >= similarityThreshold) {
+        similarityThreshold = std::max(similarity, similarityThreshold);
+        gapSizeThreshold = std::max<std::size_t>(gapSize, 1);
+        assert(similarityThreshold <= 1.0);
+        SpellSuggestion suggestion;
+        suggestion.word = word;
+        suggestion.similarity = similarity;
+        suggestions.push_back(std::move(suggestion));
+    }
+    return false;
+}
+
+///@brief The input side of `MayMatch`.
+struct CandidateFilter {
+    std::size_t inputLength;
+    uint64_t inputMask;
+};
+
+CandidateFilter MakeCandidateFilter(const std::string& input)
+{
+    CandidateFilter filter;
+    filter.inputLength = StringLength(input);
+    filter.inputMask = ComputeCharacterMask(input.data(), input.size());
+    return filter;
+}
+
+///@brief Returns `false` if `closestMatchFuzzySimilarity` can't reach the
+/// thresholds for a word of `wordLength` characters and `wordMask`.
+bool MayMatch(
+    const CandidateFilter& filter,
+    std::size_t wordLength,
+    uint64_t wordMask,
+    std::size_t gapSizeThreshold,
+    double similarityThreshold,
+    int distanceThreshold)
+{
+    // NOTE:
+    // A character class that appears in only one of the two words costs at
+    // least one character of the match, so `matchable` is an upper bound of
+    // the LCS length. The bound is exact enough to keep the same results,
+    // because the similarity is `lcs / maxLength` and the LCS can't be found
+    // within `distanceThreshold` if the unmatched characters exceed it.
+    if (ComputeGapSize(wordLength, filter.inputLength) > gapSizeThreshold) {
+        return false;
+    }
+    const std::size_t inputMatchable = filter.inputLength - PopCount(filter.inputMask & ~wordMask);
+    const std::size_t wordMatchable = wordLength - PopCount(wordMask & ~filter.inputMask);
+    const auto matchable = std::min(inputMatchable, wordMatchable);
+    if (filter.inputLength + wordLength - matchable * 2 > static_cast<std::size_t>(distanceThreshold)) {
+        return false;
+    }
+    const auto maxLength = static_cast<double>(std::max(filter.inputLength, wordLength));
+    return static_cast<double>(matchable) / maxLength >= similarityThreshold;
+}
+
+constexpr uint32_t PrefilterBlockSize = 64;
+
+///@brief Marks the words in [first, last) of the bucket whose length is
+/// within `gapSizeThreshold` of the input.
+void PrefilterBlock(
+    const WordBucket& words,
+    uint32_t first,
+    uint32_t last,
+    uint32_t inputLength,
+    uint32_t gapSizeThreshold,
+    uint32_t* passes)
+{
+    // NOTE:
+    // The offsets are a contiguous array and this loop has no branches,
+    // so the compiler can vectorize it. `MayMatch` does the rest of the
+    // filtering for the words that pass.
+    assert(last - first <= PrefilterBlockSize);
+    const auto offsets = words.offsets + first;
+    const auto count = last - first;
+    for (uint32_t i = 0; i < count; ++i) {
+        const auto wordLength = offsets[i + 1] - offsets[i];
+        const auto gapSize = (wordLength > inputLength)
+            ? (wordLength - inputLength)
+            : (inputLength - wordLength);
+        passes[i] = (gapSize <= gapSizeThreshold);
+    }
+}
+
+void SpellCheckInternal(
+    const std::string& input,
+    const WordBucket& words,
+    const SignatureHashingDictionary& signatureDictionary,
+    std::vector<SpellSuggestion> & suggestions,
+    bool & exactMatching,
+    const CandidateFilter& filter,
+    std::size_t & gapSizeThreshold,
+    double & similarityThreshold,
+    int distanceThreshold)
+{
+    // NOTE: Words longer than 4 GiB can't be in a bucket.
+    const auto inputLength = static_cast<uint32_t>(
+        std::min<std::size_t>(filter.inputLength, std::numeric_limits<uint32_t>::max()));
+
+    std::array<uint32_t, PrefilterBlockSize> passes;
+    std::string word;
+    for (uint32_t first = 0; first < words.wordCount; first += PrefilterBlockSize) {
+        const auto last = std::min(first + PrefilterBlockSize, words.wordCount);
+        PrefilterBlock(words, first, last, inputLength,
+            static_cast<uint32_t>(gapSizeThreshold), passes.data());
+
+        for (auto i = first; i < last; ++i) {
+            // NOTE: The thresholds may have been tightened since the block was filtered.
+            const auto wordLength = GetWordLength(words, i);
+            if (!passes[i - first] || !MayMatch(filter, wordLength, words.masks[i],
+                    gapSizeThreshold, similarityThreshold, distanceThreshold)) {
+                continue;
+            }
+
+            if (signatureDictionary.stats != nullptr) {
+                ++signatureDictionary.stats->scoredCandidateCount;
+            }
+            const auto entry = GetWord(words, i);
+            word.assign(entry.data(), entry.size());
+            exactMatching = SpellCheckCandidate(
+                input,
+                word,
+                ComputeGapSize(wordLength, filter.inputLength),
+                signatureDictionary,
+                suggestions,
+                gapSizeThreshold,
+                similarityThreshold,
+                distanceThreshold);
+            if (exactMatching) {
+                return;
+            }
+        }
+    }
+}
+
+std::size_t ComputePrefixLength(const std::string& a, const std::string& b)
+{
+    const auto minSize = std::min(a.size(), b.size());
+    std::size_t prefixLength = 0;
+    for (std::size_t i = 0; i < minSize; ++i) {
+        assert(i < a.size());
+        assert(i < b.size());
+        if (a[i] != b[i]) {
+            break;
+        }
+        ++prefixLength;
+    }
+    return prefixLength;
+}
+
+std::size_t ComputeSurfixLength(const std::string& a, const std::string& b)
+{
+    const auto minSize = std::min(a.size(), b.size());
+    std::size_t surfixLength = 0;
+    for (std::size_t i = 1; i <= minSize; ++i) {
+        assert(i <= a.size());
+        assert(i <= b.size());
+        if (a[a.size() - i] != b[b.size() - i]) {
+            break;
+        }
+        ++surfixLength;
+    }
+    return surfixLength;
+}
+
+struct SuggestionRankingKey {
+    double similarity;
+    int distance;
+    std::size_t prefixLength;
+    std::size_t gapSize;
+    std::size_t surfixLength;
+    std::size_t index;
+};
+
+bool RanksBefore(const SuggestionRankingKey& a, const SuggestionRankingKey& b)
+{
+    if (a.similarity != b.similarity) {
+        return a.similarity > b.similarity;
+    }
+    if (a.distance != b.distance) {
+        return a.distance < b.distance;
+    }
+    if (a.prefixLength != b.prefixLength) {
+        return a.prefixLength > b.prefixLength;
+    }
+    if (a.gapSize != b.gapSize) {
+        return a.gapSize < b.gapSize;
+    }
+    if (a.surfixLength != b.surfixLength) {
+        return a.surfixLength > b.surfixLength;
+    }
+    return a.index < b.index;
+}
+
+void SortSuggestions(
+    const std::string& word,
+    std::vector<SpellSuggestion>& suggestions,
+    std::size_t maxSuggestions)
+{
+    // NOTE:
+    // The ranking keys are computed once per suggestion and only the best
+    // `maxSuggestions` are sorted. Ties keep the original order.
+    std::vector<SuggestionRankingKey> keys;
+    keys.reserve(suggestions.size());
+    for (std::size_t i = 0; i < suggestions.size(); ++i) {
+        auto & suggestion = suggestions[i];
+        if (!suggestion.similarity) {
+            suggestion.similarity = somera::closestMatchFuzzySimilarity(word, suggestion.word);
+        }
+        SuggestionRankingKey key;
+        key.similarity = *suggestion.similarity;
+        key.distance = somera::levenshteinDistance_BitParallel_ReplacementCost1(word, suggestion.word);
+        key.prefixLength = ComputePrefixLength(word, suggestion.word);
+        key.gapSize = ComputeGapSize(word.size(), suggestion.word.size());
+        key.surfixLength = ComputeSurfixLength(word, suggestion.word);
+        key.index = i;
+        keys.push_back(key);
+    }
+
+    const auto count = std::min(maxSuggestions, keys.size());
+    std::partial_sort(
+        std::begin(keys),
+        std::next(std::begin(keys), count),
+        std::end(keys),
+        RanksBefore);
+
+    std::vector<SpellSuggestion> sorted;
+    sorted.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        sorted.push_back(std::move(suggestions[keys[i].index]));
+    }
+    std::swap(suggestions, sorted);
+}
+
+SpellCheckResultInternal SpellCheck_SignatureHashinging_Internal(
+    const std::string& input,
+    const SignatureHashingDictionary& dictionary,
+    const std::function<uint32_t(const std::string&)>& histogramHashing,
+    const int maxHashLength,
+    const int distanceThreshold)
+{
+    std::size_t gapSizeThreshold = 2;
+
+    SpellCheckResultInternal result;
+    result.correctlySpelled = false;
+
+    const auto inputHistogramHashing = histogramHashing(input);
+    const auto filter = MakeCandidateFilter(input);
+
+    const auto sizeAsDouble = static_cast<double>(filter.inputLength);
+    double similarityThreshold = std::max((sizeAsDouble - std::min(sizeAsDouble, 2.0)) / sizeAsDouble, 0.5);
+
+    for (int i = 0; i <= maxHashLength; ++i) {
+        const uint32_t bitmask = ((static_cast<uint32_t>(1) << i) >> 1);
+        const uint32_t xorBits = inputHistogramHashing ^ bitmask;
+
+        bool exactMatching = false;
+
+        if (dictionary.compiledDictionary != nullptr) {
+            auto words = dictionary.compiledDictionary->FindBucket(xorBits);
+            CountBucketLookup(dictionary, words);
+            if (words) {
+                SpellCheckInternal(
+                    input,
+                    *words,
+                    dictionary,
+                    result.suggestions,
+                    exactMatching,
+                    filter,
+                    gapSizeThreshold,
+                    similarityThreshold,
+                    distanceThreshold);
+            }
+        }
+
+        if (exactMatching) {
+            result.correctlySpelled = true;
+            break;
+        }
+
+        auto words = dictionary.hashedDictionary.FindBucket(xorBits);
+        CountBucketLookup(dictionary, words);
+        if (words) {
+            SpellCheckInternal(
+                input,
+                *words,
+                dictionary,
+                result.suggestions,
+                exactMatching,
+                filter,
+                gapSizeThreshold,
+                similarityThreshold,
+                distanceThreshold);
+        }
+
+        if (exactMatching) {
+            result.correctlySpelled = true;
+            break;
+        }
+    }
+    return result;
+}
+
+Optional<SpellSuggestion> ExistWordSignatureHashingingInternal(
+    const std::string& input,
+    const SignatureHashingDictionary& dictionary)
+{
+    std::size_t gapSizeThreshold = 1;
+    const int distanceThreshold = 1;
+
+    const auto filter = MakeCandidateFilter(input);
+
+    double similarityThreshold = 0.8;
+
+    const auto histogramHashing = SignatureHashingFromAsciiAlphabet;
+    const auto inputHistogramHashing = histogramHashing(input);
+
+    Optional<SpellSuggestion> currentSuggestion;
+
+    // NOTE: Returns `true` on exact matching.
+    auto findInBucket = [&](const WordBucket& words) -> bool {
+        for (uint32_t i = 0; i < words.wordCount; ++i) {
+            const auto wordLength = GetWordLength(words, i);
+            if (!MayMatch(filter, wordLength, words.masks[i],
+                    gapSizeThreshold, similarityThreshold, distanceThreshold)) {
+                continue;
+            }
+
+            if (dictionary.stats != nullptr) {
+                ++dictionary.stats->scoredCandidateCount;
+            }
+            const auto gapSize = ComputeGapSize(wordLength, filter.inputLength);
+            const auto word = GetWord(words, i).toString();
+            const auto similarity = closestMatchFuzzySimilarity(input, word, distanceThreshold, similarityThreshold);
+            if ((similarity >= similarityThreshold) && IsRemovedWord(dictionary, word)) {
+                continue;
+            }
+            if (similarity == 1.0) {
+                // exaxt matching
+                SpellSuggestion suggestion;
+                suggestion.word = word;
+                suggestion.similarity = similarity;
+                currentSuggestion = std::move(suggestion);
+                return true;
+            }
+            else if (similarity >= similarityThreshold) {
+                similarityThreshold = std::max(similarity, similarityThreshold);
+                gapSizeThreshold = std::max<std::size_t>(gapSize, 1);
+                assert(similarityThreshold <= 1.0);
+                SpellSuggestion suggestion;
+                suggestion.word = word;
+                suggestion.similarity = similarity;
+                currentSuggestion = std::move(suggestion);
+            }
+        }
+        return false;
+    };
+
+    if (dictionary.compiledDictionary != nullptr) {
+        auto words = dictionary.compiledDictionary->FindBucket(inputHistogramHashing);
+        CountBucketLookup(dictionary, words);
+        if (words && findInBucket(*words)) {
+            return currentSuggestion;
+        }
+    }
+
+    auto words = dictionary.hashedDictionary.FindBucket(inputHistogramHashing);
+    CountBucketLookup(dictionary, words);
+    if (words) {
+        findInBucket(*words);
+    }
+    return currentSuggestion;
+}
+
+enum class LetterCase {
+    LowerCase,
+    UpperCase,
+    UpperCamelCase,
+};
+
+LetterCase GetLetterCase(const std::string& word)
+{
+    ///@todo This function doesn't support UTF-8 string.
+    bool isLowerCase = true;
+    bool isUpperCase = true;
+    bool isUpperCamelCase = true;
+    if (word.empty() || (::isupper(word.front()) == 0)) {
+        isUpperCamelCase = false;
+    }
+    for (auto c : word) {
+        if (::islower(c) != 0) {
+            isUpperCase = false;
+        }
+        if (::isupper(c) != 0) {
+            isLowerCase = false;
+        }
+    }
+    if (isLowerCase) {
+        return LetterCase::LowerCase;
+    }
+    else if (isUpperCase) {
+        return LetterCase::UpperCase;
+    }
+    else if (isUpperCamelCase) {
+        return LetterCase::UpperCamelCase;
+    }
+    return LetterCase::LowerCase;
+}
+
+#if 0
+void TestCase_GetLetterCase()
+{
+    assert(GetLetterCase("Word") == LetterCase::UpperCamelCase);
+    assert(GetLetterCase("WORD") == LetterCase::UpperCase);
+    assert(GetLetterCase("word") == LetterCase::LowerCase);
+}
+#endif
+
+void TransformLetterCase(std::string & word, LetterCase letterCase)
+{
+    switch (letterCase) {
+    case LetterCase::LowerCase:
+        for (auto & c : word) {
+            c = ::tolower(c);
+        }
+        break;
+    case LetterCase::UpperCase:
+        for (auto & c : word) {
+            c = ::toupper(c);
+        }
+        break;
+    case LetterCase::UpperCamelCase: {
+        for (auto & c : word) {
+            c = ::tolower(c);
+        }
+        if (!word.empty()) {
+            auto & c = word.front();
+            c = ::toupper(c);
+        }
+        break;
+    }
+    }
+}
+
+///@brief Returns the exact match of `word` if the search of the signature
+/// buckets would stop at the same word, and `SuggestLetterCase` would turn it
+/// back into `word`. Otherwise the fuzzy search has to decide.
+Optional<SpellSuggestion> FindExactWord(
+    const std::string& word,
+    const SignatureHashingDictionary& dictionary)
+{
+    // NOTE:
+    // The search stops at the first exact match in the buckets, so the
+    // result is only known here if one dictionary word equals `word`
+    // ignoring case. The words in the compiled dictionary are not added to
+    // the hashed one, but their case variants may be.
+    StringView compiledWord;
+    StringView hashedWord;
+    const auto compiledVariants = (dictionary.compiledDictionary != nullptr)
+        ? dictionary.compiledDictionary->FindCaseVariant(word, compiledWord)
+        : CaseVariants::None;
+    const auto hashedVariants = dictionary.exactWords.FindCaseVariant(word, hashedWord);
+    if ((compiledVariants == CaseVariants::Many) || (hashedVariants == CaseVariants::Many)) {
+        return NullOpt;
+    }
+    if ((compiledVariants == CaseVariants::One) && (hashedVariants == CaseVariants::One)) {
+        return NullOpt;
+    }
+    if ((compiledVariants == CaseVariants::None) && (hashedVariants == CaseVariants::None)) {
+        return NullOpt;
+    }
+    const auto dictionaryWord = (compiledVariants == CaseVariants::One)
+        ? compiledWord.toString()
+        : hashedWord.toString();
+    assert(dictionaryWord.size() == word.size());
+
+    // NOTE:
+    // Same as `matchCharacter`, a letter of the dictionary word matches
+    // itself, and a lower case one also matches its upper case.
+    for (std::size_t i = 0; i < word.size(); ++i) {
+        if ((word[i] != dictionaryWord[i])
+            && (IsUpperAscii(dictionaryWord[i]) || (ToLowerAscii(word[i]) != dictionaryWord[i]))) {
+            return NullOpt;
+        }
+    }
+    if (IsRemovedWord(dictionary, dictionaryWord)) {
+        return NullOpt;
+    }
+
+    auto correctedWord = dictionaryWord;
+    if (GetLetterCase(correctedWord) == LetterCase::LowerCase) {
+        TransformLetterCase(correctedWord, GetLetterCase(word));
+    }
+    if (correctedWord != word) {
+        // NOTE: "hELLO" is reported as a misspelling of "hello".
+        return NullOpt;
+    }
+
+    SpellSuggestion suggestion;
+    suggestion.word = dictionaryWord;
+    suggestion.similarity = 1.0;
+    return suggestion;
+}
+
+SpellCheckResultInternal SuggestInternal(
+    const std::string& word,
+    const SignatureHashingDictionary& dictionary)
+{
+    if (auto suggestion = FindExactWord(word, dictionary)) {
+        if (dictionary.stats != nullptr) {
+            ++dictionary.stats->exactHitCount;
+        }
+        SpellCheckResultInternal result;
+        result.correctlySpelled = true;
+        result.suggestions.push_back(std::move(*suggestion));
+        return result;
+    }
+
+    const auto distanceThreshold = std::min(static_cast<int>(word.size()), 10);
+    return SpellCheck_SignatureHashinging_Internal(
+        word,
+        dictionary,
+        SignatureHashingFromAsciiAlphabet,
+        28,
+        distanceThreshold);
+}
+
+Optional<SpellSuggestion> ExistWordInternal(
+    const std::string& input,
+    const SignatureHashingDictionary& dictionary)
+{
+    return ExistWordSignatureHashingingInternal(input, dictionary);
+}
+
+struct SignatureHashingProbe {
+    const std::string* input;
+    SpellCheckResultInternal result;
+    uint32_t signature;
+    CandidateFilter filter;
+    std::size_t gapSizeThreshold;
+    double similarityThreshold;
+    int distanceThreshold;
+    bool exactMatching;
+};
+
+SignatureHashingProbe MakeSignatureHashingProbe(const std::string& input)
+{
+    SignatureHashingProbe probe;
+    probe.input = &input;
+    probe.result.correctlySpelled = false;
+    probe.signature = SignatureHashingFromAsciiAlphabet(input);
+    probe.filter = MakeCandidateFilter(input);
+    probe.gapSizeThreshold = 2;
+    const auto sizeAsDouble = static_cast<double>(probe.filter.inputLength);
+    probe.similarityThreshold = std::max((sizeAsDouble - std::min(sizeAsDouble, 2.0)) / sizeAsDouble, 0.5);
+    probe.distanceThreshold = std::min(static_cast<int>(input.size()), 10);
+    probe.exactMatching = false;
+    return probe;
+}
+
+void SpellCheckBucketForProbes(
+    const WordBucket& words,
+    const SignatureHashingDictionary& dictionary,
+    const std::vector<SignatureHashingProbe*>& probes)
+{
+    // NOTE:
+    // Walks the bucket once for all probes. Each probe still sees the
+    // entries in the same order as `SpellCheckInternal` does.
+    std::size_t activeCount = 0;
+    for (auto probe : probes) {
+        if (!probe->exactMatching) {
+            ++activeCount;
+        }
+    }
+    std::string word;
+    for (uint32_t i = 0; (i < words.wordCount) && (activeCount > 0); ++i) {
+        const auto wordLength = GetWordLength(words, i);
+        const auto wordMask = words.masks[i];
+        word.clear();
+        for (auto probe : probes) {
+            if (probe->exactMatching) {
+                continue;
+            }
+            if (!MayMatch(probe->filter, wordLength, wordMask,
+                    probe->gapSizeThreshold, probe->similarityThreshold, probe->distanceThreshold)) {
+                continue;
+            }
+            if (dictionary.stats != nullptr) {
+                ++dictionary.stats->scoredCandidateCount;
+            }
+            if (word.empty()) {
+                const auto entry = GetWord(words, i);
+                word.assign(entry.data(), entry.size());
+            }
+            probe->exactMatching = SpellCheckCandidate(
+                *probe->input,
+                word,
+                ComputeGapSize(wordLength, probe->filter.inputLength),
+                dictionary,
+                probe->result.suggestions,
+                probe->gapSizeThreshold,
+                probe->similarityThreshold,
+                probe->distanceThreshold);
+            if (probe->exactMatching) {
+                --activeCount;
+            }
+        }
+    }
+}
+
+///@brief Same as `SuggestInternal` for each probe, but the probes that look
+/// up the same bucket in a round share a single lookup and walk.
+void SuggestInternalBatch(
+    std::vector<SignatureHashingProbe> & probes,
+    const SignatureHashingDictionary& dictionary)
+{
+    constexpr int maxHashLength = 28;
+
+    std::vector<SignatureHashingProbe*> activeProbes;
+    activeProbes.reserve(probes.size());
+    for (auto & probe : probes) {
+        activeProbes.push_back(&probe);
+    }
+
+    std::vector<SignatureHashingProbe*> group;
+    for (int i = 0; (i <= maxHashLength) && !activeProbes.empty(); ++i) {
+        const uint32_t bitmask = ((static_cast<uint32_t>(1) << i) >> 1);
+        std::sort(std::begin(activeProbes), std::end(activeProbes),
+            [&](const SignatureHashingProbe* a, const SignatureHashingProbe* b) {
+                return (a->signature ^ bitmask) < (b->signature ^ bitmask);
+            });
+
+        auto first = std::begin(activeProbes);
+        while (first != std::end(activeProbes)) {
+            const uint32_t xorBits = (*first)->signature ^ bitmask;
+            auto last = std::find_if(first, std::end(activeProbes), [&](const SignatureHashingProbe* probe) {
+                return (probe->signature ^ bitmask) != xorBits;
+            });
+            group.assign(first, last);
+            first = last;
+
+            if (dictionary.compiledDictionary != nullptr) {
+                auto words = dictionary.compiledDictionary->FindBucket(xorBits);
+                CountBucketLookup(dictionary, words);
+                if (words) {
+                    SpellCheckBucketForProbes(*words, dictionary, group);
+                }
+            }
+            auto words = dictionary.hashedDictionary.FindBucket(xorBits);
+            CountBucketLookup(dictionary, words);
+            if (words) {
+                SpellCheckBucketForProbes(*words, dictionary, group);
+            }
+        }
+
+        for (auto probe : activeProbes) {
+            if (probe->exactMatching) {
+                probe->result.correctlySpelled = true;
+            }
+        }
+        activeProbes.erase(
+            std::remove_if(std::begin(activeProbes), std::end(activeProbes),
+                [](const SignatureHashingProbe* probe) { return probe->exactMatching; }),
+            std::end(activeProbes));
+    }
+}
+
+///@brief A signature hashing dictionary with the first-stage result of one
+/// word already computed by `SuggestInternalBatch`.
+struct PrecomputedSignatureHashingDictionary {
+    const SignatureHashingDictionary& dictionary;
+    const std::string& word;
+    const SpellCheckResultInternal& result;
+};
+
+SpellCheckResultInternal SuggestInternal(
+    const std::string& word,
+    const PrecomputedSignatureHashingDictionary& dictionary)
+{
+    if (word == dictionary.word) {
+        return dictionary.result;
+    }
+    return SuggestInternal(word, dictionary.dictionary);
+}
+
+Optional<SpellSuggestion> ExistWordInternal(
+    const std::string& input,
+    const PrecomputedSignatureHashingDictionary& dictionary)
+{
+    return ExistWordInternal(input, dictionary.dictionary);
+}
+
+SpellCheckerStats* GetStats(const PrecomputedSignatureHashingDictionary& dictionary)
+{
+    return GetStats(dictionary.dictionary);
+}
+
+std::vector<std::string> UniqueWords(const std::vector<std::string>& words)
+{
+    auto uniqueWords = words;
+    std::sort(std::begin(uniqueWords), std::end(uniqueWords));
+    uniqueWords.erase(
+        std::unique(std::begin(uniqueWords), std::end(uniqueWords)),
+        std::end(uniqueWords));
+    return uniqueWords;
+}
+
+std::vector<SpellCheckResult> ExpandUniqueResults(
+    const std::vector<std::string>& words,
+    const std::vector<std::string>& uniqueWords,
+    const std::vector<SpellCheckResult>& uniqueResults)
+{
+    assert(uniqueWords.size() == uniqueResults.size());
+    std::vector<SpellCheckResult> results;
+    results.reserve(words.size());
+    for (auto & word : words) {
+        auto iter = std::lower_bound(std::begin(uniqueWords), std::end(uniqueWords), word);
+        assert(iter != std::end(uniqueWords) && *iter == word);
+        results.push_back(uniqueResults[std::distance(std::begin(uniqueWords), iter)]);
+    }
+    return results;
+}
+
+uint32_t ComputeDeletionHash(const std::string& word)
+{
+    // NOTE: FNV-1a 32-bit hash
+    uint32_t hash = 2166136261u;
+    for (auto c : word) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+struct DeletionHash {
+    uint32_t hash;
+    int deletionCount;
+};
+
+void GenerateDeletionHashes(
+    const std::string& word,
+    int deletionCount,
+    int maxDeletionCount,
+    std::vector<DeletionHash> & hashes)
+{
+    hashes.push_back(DeletionHash{ComputeDeletionHash(word), deletionCount});
+    if ((deletionCount >= maxDeletionCount) || (word.size() <= 1)) {
+        return;
+    }
+    std::string deletion;
+    for (std::size_t i = 0; i < word.size(); ++i) {
+        deletion = word;
+        deletion.erase(i, 1);
+        GenerateDeletionHashes(deletion, deletionCount + 1, maxDeletionCount, hashes);
+    }
+}
+
+std::vector<DeletionHash> GenerateDeletionHashes(const std::string& word, int maxDeletionCount)
+{
+    std::vector<DeletionHash> hashes;
+    GenerateDeletionHashes(word, 0, maxDeletionCount, hashes);
+
+    // NOTE: Keep the fewest deletions for each hash.
+    std::sort(std::begin(hashes), std::end(hashes), [](const DeletionHash& a, const DeletionHash& b) {
+        return (a.hash != b.hash) ? (a.hash < b.hash) : (a.deletionCount < b.deletionCount);
+    });
+    hashes.erase(std::unique(std::begin(hashes), std::end(hashes), [](const DeletionHash& a, const DeletionHash& b) {
+        return a.hash == b.hash;
+    }), std::end(hashes));
+    return hashes;
+}
+
+class SymmetricDeleteDictionary final {
+public:
+    static constexpr int maxEditDistance = 2;
+
+    // NOTE:
+    // Deletion variants are generated only from the first `prefixLength`
+    // characters of each word to bound the index size (see SymSpell).
+    static constexpr std::size_t prefixLength = 7;
+
+    void AddWord(const std::string& word);
+
+    void RemoveWord(const std::string& word);
+
+    ///@brief Makes the words added since the last build searchable. The
+    /// lookups must not be called while words are pending.
+    void BuildDeletionIndex();
+
+    bool ExistsExactly(const std::string& word) const;
+
+    void FindCandidates(
+        const std::string& lowerInput,
+        int editDistance,
+        std::vector<uint32_t> & candidates) const;
+
+    const std::string& GetWord(uint32_t wordIndex) const
+    {
+        assert(wordIndex < removedFlags.size());
+        const auto mergedCount = merged->words.size();
+        return (wordIndex < mergedCount) ? merged->words[wordIndex] : addedWords[wordIndex - mergedCount];
+    }
+
+    const std::string& GetLowerWord(uint32_t wordIndex) const
+    {
+        assert(wordIndex < removedFlags.size());
+        const auto mergedCount = merged->lowerWords.size();
+        return (wordIndex < mergedCount) ? merged->lowerWords[wordIndex] : addedLowerWords[wordIndex - mergedCount];
+    }
+
+private:
+    struct DeletionEntry {
+        uint32_t hash;
+        uint32_t wordIndex : 30;
+        uint32_t deletionCount : 2;
+    };
+
+    ///@brief The words and the deletion index as of the last merge. Copies
+    /// of a dictionary share it, so copying a dictionary only copies the
+    /// words added after the merge.
+    struct MergedIndex {
+        std::vector<std::string> words;
+        std::vector<std::string> lowerWords;
+        std::unordered_map<std::string, uint32_t> wordIndices;
+
+        // NOTE:
+        // The deletion index is a flat array grouped into power-of-two buckets
+        // by hash, so a lookup is a single offset read and a short scan.
+        std::vector<DeletionEntry> deletions;
+        std::vector<uint32_t> bucketOffsets;
+        int bucketShift = 32;
+    };
+
+    bool FindWordIndex(const std::string& word, uint32_t& wordIndex) const;
+
+    void MergeDeletionIndex();
+
+    std::shared_ptr<const MergedIndex> merged = std::make_shared<const MergedIndex>();
+
+    // NOTE:
+    // The words added since the last merge follow the merged words. Their
+    // deletion entries are kept sorted by hash and searched with a binary
+    // search until there are enough of them to be worth a merge.
+    std::vector<std::string> addedWords;
+    std::vector<std::string> addedLowerWords;
+    std::unordered_map<std::string, uint32_t> addedWordIndices;
+    std::vector<DeletionEntry> addedDeletions;
+    std::vector<DeletionEntry> pendingDeletions;
+    std::vector<bool> removedFlags;
+};
+
+constexpr int SymmetricDeleteDictionary::maxEditDistance;
+constexpr std::size_t SymmetricDeleteDictionary::prefixLength;
+
+bool SymmetricDeleteDictionary::FindWordIndex(const std::string& word, uint32_t& wordIndex) const
+{
+    auto iter = merged->wordIndices.find(word);
+    if (iter != std::end(merged->wordIndices)) {
+        wordIndex = iter->second;
+        return true;
+    }
+    iter = addedWordIndices.find(word);
+    if (iter != std::end(addedWordIndices)) {
+        wordIndex = iter->second;
+        return true;
+    }
+    return false;
+}
+
+void SymmetricDeleteDictionary::AddWord(const std::string& word)
+{
+    assert(!word.empty());
+
+    uint32_t wordIndex = 0;
+    if (FindWordIndex(word, wordIndex)) {
+        // NOTE: The word already exists in a dictionary.
+        removedFlags[wordIndex] = false;
+        return;
+    }
+
+    wordIndex = static_cast<uint32_t>(removedFlags.size());
+    addedWords.push_back(word);
+    addedLowerWords.push_back(StringHelper::toLower(word));
+    removedFlags.push_back(false);
+    addedWordIndices.emplace(word, wordIndex);
+
+    const auto hashes = GenerateDeletionHashes(
+        addedLowerWords.back().substr(0, prefixLength), maxEditDistance);
+
+    for (auto & deletion : hashes) {
+        DeletionEntry entry;
+        entry.hash = deletion.hash;
+        entry.wordIndex = wordIndex;
+        entry.deletionCount = static_cast<uint32_t>(deletion.deletionCount);
+        pendingDeletions.push_back(entry);
+    }
+}
+
+void SymmetricDeleteDictionary::RemoveWord(const std::string& word)
+{
+    uint32_t wordIndex = 0;
+    if (!FindWordIndex(word, wordIndex)) {
+        return;
+    }
+    // NOTE: The deletion entries are kept and filtered out by the flag.
+    removedFlags[wordIndex] = true;
+}
+
+bool SymmetricDeleteDictionary::ExistsExactly(const std::string& word) const
+{
+    uint32_t wordIndex = 0;
+    return FindWordIndex(word, wordIndex) && !removedFlags[wordIndex];
+}
+
+void SymmetricDeleteDictionary::BuildDeletionIndex()
+{
+    if (pendingDeletions.empty()) {
+        return;
+    }
+
+    addedDeletions.insert(std::end(addedDeletions), std::begin(pendingDeletions), std::end(pendingDeletions));
+    pendingDeletions.clear();
+    pendingDeletions.shrink_to_fit();
+
+    // NOTE:
+    // Merging copies the whole index, so it waits until the added entries
+    // are an eighth of the merged ones. Each entry is copied a constant
+    // number of times on average, and a few added words stay cheap.
+    if (addedDeletions.size() * 8 < merged->deletions.size()) {
+        std::sort(std::begin(addedDeletions), std::end(addedDeletions), [](const DeletionEntry& a, const DeletionEntry& b) {
+            return a.hash < b.hash;
+        });
+        return;
+    }
+    MergeDeletionIndex();
+}
+
+void SymmetricDeleteDictionary::MergeDeletionIndex()
+{
+    auto index = std::make_shared<MergedIndex>(*merged);
+    index->words.insert(std::end(index->words),
+        std::make_move_iterator(std::begin(addedWords)), std::make_move_iterator(std::end(addedWords)));
+    index->lowerWords.insert(std::end(index->lowerWords),
+        std::make_move_iterator(std::begin(addedLowerWords)), std::make_move_iterator(std::end(addedLowerWords)));
+    index->wordIndices.insert(std::begin(addedWordIndices), std::end(addedWordIndices));
+    addedWords.clear();
+    addedLowerWords.clear();
+    addedWordIndices.clear();
+
+    std::vector<DeletionEntry> entries;
+    entries.reserve(index->deletions.size() + addedDeletions.size());
+    entries.insert(std::end(entries), std::begin(index->deletions), std::end(index->deletions));
+    entries.insert(std::end(entries), std::begin(addedDeletions), std::end(addedDeletions));
+    addedDeletions.clear();
+    addedDeletions.shrink_to_fit();
+
+    // NOTE: Use about two entries per bucket.
+    int bucketBits = 10;
+    while ((bucketBits < 30) && ((static_cast<std::size_t>(1) << (bucketBits + 1)) < entries.size())) {
+        ++bucketBits;
+    }
+    const auto bucketShift = 32 - bucketBits;
+    const auto bucketCount = static_cast<std::size_t>(1) << bucketBits;
+    index->bucketShift = bucketShift;
+
+    // NOTE: Counting sort by bucket
+    auto & bucketOffsets = index->bucketOffsets;
+    bucketOffsets.assign(bucketCount + 1, 0);
+    for (auto & entry : entries) {
+        ++bucketOffsets[(entry.hash >> bucketShift) + 1];
+    }
+    for (std::size_t i = 1; i <= bucketCount; ++i) {
+        bucketOffsets[i] += bucketOffsets[i - 1];
+    }
+    index->deletions.resize(entries.size());
+    std::vector<uint32_t> positions(std::begin(bucketOffsets), std::prev(std::end(bucketOffsets)));
+    for (auto & entry : entries) {
+        index->deletions[positions[entry.hash >> bucketShift]++] = entry;
+    }
+    merged = std::move(index);
+}
+
+void SymmetricDeleteDictionary::FindCandidates(
+    const std::string& lowerInput,
+    int editDistance,
+    std::vector<uint32_t> & candidates) const
+{
+    assert(pendingDeletions.empty());
+
+    // NOTE:
+    // A word whose prefix needs more deletions than `editDistance` to reach
+    // the shared variant is farther than `editDistance` from the input.
+    const auto hashes = GenerateDeletionHashes(lowerInput.substr(0, prefixLength), editDistance);
+
+    auto addCandidate = [&](const DeletionEntry& entry, uint32_t hash) {
+        if ((entry.hash == hash)
+            && (static_cast<int>(entry.deletionCount) <= editDistance)
+            && !removedFlags[entry.wordIndex]) {
+            candidates.push_back(entry.wordIndex);
+        }
+    };
+
+    for (auto & deletion : hashes) {
+        if (!merged->bucketOffsets.empty()) {
+            const auto bucket = deletion.hash >> merged->bucketShift;
+            const auto first = merged->bucketOffsets[bucket];
+            const auto last = merged->bucketOffsets[bucket + 1];
+            for (auto i = first; i < last; ++i) {
+                addCandidate(merged->deletions[i], deletion.hash);
+            }
+        }
+        auto iter = std::lower_bound(std::begin(addedDeletions), std::end(addedDeletions), deletion.hash,
+            [](const DeletionEntry& entry, uint32_t hash) { return entry.hash < hash; });
+        for (; (iter != std::end(addedDeletions)) && (iter->hash == deletion.hash); ++iter) {
+            addCandidate(*iter, deletion.hash);
+        }
+    }
+    std::sort(std::begin(candidates), std::end(candidates));
+    candidates.erase(std::unique(std::begin(candidates), std::end(candidates)), std::end(candidates));
+}
+
+SpellCheckResultInternal SuggestInternal(
+    const std::string& input,
+    const SymmetricDeleteDictionary& dictionary)
+{
+    SpellCheckResultInternal result;
+    result.correctlySpelled = false;
+
+    const auto inputWordSize = StringLength(input);
+    const auto sizeAsDouble = static_cast<double>(inputWordSize);
+    const double similarityThreshold = std::max((sizeAsDouble - std::min(sizeAsDouble, 2.0)) / sizeAsDouble, 0.5);
+    const auto editDistance = SymmetricDeleteDictionary::maxEditDistance;
+
+    const auto lowerInput = StringHelper::toLower(input);
+    if (dictionary.ExistsExactly(input) || dictionary.ExistsExactly(lowerInput)) {
+        // exaxt matching
+        SpellSuggestion suggestion;
+        suggestion.word = dictionary.ExistsExactly(input) ? input : lowerInput;
+        suggestion.similarity = 1.0;
+        result.suggestions.push_back(std::move(suggestion));
+        result.correctlySpelled = true;
+        return result;
+    }
+
+    std::vector<uint32_t> candidates;
+    dictionary.FindCandidates(lowerInput, editDistance, candidates);
+
+    // NOTE:
+    // Only the candidates at the closest edit distance are kept, like the
+    // "closest" verbosity of SymSpell.
+    int bestDistance = editDistance;
+
+    for (auto wordIndex : candidates) {
+        const auto& word = dictionary.GetWord(wordIndex);
+        if (ComputeGapSize(StringLength(word), inputWordSize) > static_cast<std::size_t>(bestDistance)) {
+            continue;
+        }
+        const auto distance = levenshteinDistance_BitParallel_ReplacementCost1(
+            lowerInput, dictionary.GetLowerWord(wordIndex));
+        if (distance > bestDistance) {
+            continue;
+        }
+
+        const auto similarity = closestMatchFuzzySimilarity(
+            input, word, static_cast<int>(input.size() + word.size()), similarityThreshold);
+        if (similarity == 1.0) {
+            // exaxt matching
+            SpellSuggestion suggestion;
+            suggestion.word = word;
+            suggestion.similarity = similarity;
+            result.suggestions.insert(std::begin(result.suggestions), std::move(suggestion));
+            result.correctlySpelled = true;
+            break;
+        }
+        else if (similarity >= similarityThreshold) {
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                result.suggestions.clear();
+            }
+            SpellSuggestion suggestion;
+            suggestion.word = word;
+            suggestion.similarity = similarity;
+            result.suggestions.push_back(std::move(suggestion));
+        }
+    }
+    return result;
+}
+
+Optional<SpellSuggestion> ExistWordInternal(
+    const std::string& input,
+    const SymmetricDeleteDictionary& dictionary)
+{
+    const std::size_t gapSizeThreshold = 1;
+    const int editDistance = 1;
+    double similarityThreshold = 0.8;
+
+    const auto inputWordSize = StringLength(input);
+    const auto lowerInput = StringHelper::toLower(input);
+    if (dictionary.ExistsExactly(input) || dictionary.ExistsExactly(lowerInput)) {
+        SpellSuggestion suggestion;
+        suggestion.word = dictionary.ExistsExactly(input) ? input : lowerInput;
+        suggestion.similarity = 1.0;
+        return suggestion;
+    }
+
+    std::vector<uint32_t> candidates;
+    dictionary.FindCandidates(lowerInput, editDistance, candidates);
+
+    Optional<SpellSuggestion> currentSuggestion;
+
+    for (auto wordIndex : candidates) {
+        const auto& word = dictionary.GetWord(wordIndex);
+        if (ComputeGapSize(StringLength(word), inputWordSize) > gapSizeThreshold) {
+            continue;
+        }
+        const auto distance = levenshteinDistance_BitParallel_ReplacementCost1(
+            lowerInput, dictionary.GetLowerWord(wordIndex));
+        if (distance > editDistance) {
+            continue;
+        }
+
+        const auto similarity = closestMatchFuzzySimilarity(input, word, editDistance, similarityThreshold);
+        if (similarity == 1.0) {
+            // exaxt matching
+            SpellSuggestion suggestion;
+            suggestion.word = word;
+            suggestion.similarity = similarity;
+            return suggestion;
+        }
+        else if (similarity >= similarityThreshold) {
+            similarityThreshold = similarity;
+            SpellSuggestion suggestion;
+            suggestion.word = word;
+            suggestion.similarity = similarity;
+            currentSuggestion = std::move(suggestion);
+        }
+    }
+    return currentSuggestion;
+}
+
+///@brief A minimal acyclic word graph (DAWG) of sorted words.
+///
+/// Words that share prefixes share a path from the root, and words that
+/// share suffixes share the nodes at the end, so the graph is much smaller
+/// than the word list. The graph is built from the sorted words in one pass
+/// (Daciuk et al., "Incremental Construction of Minimal Acyclic Finite-State
+/// Automata") and is immutable.
+class DawgGraph final {
+public:
+    explicit DawgGraph(const std::vector<std::string>& sortedWords)
+    {
+        BuildFromSortedWords(sortedWords);
+    }
+
+    bool Contains(const std::string& word) const;
+
+    ///@brief Appends the words of the graph to `words` in sorted order.
+    void CollectWords(std::vector<std::string> & words) const;
+
+    ///@brief Calls `callback(word, distance)` for each word within
+    /// `editDistance` of `lowerInput`, ignoring the letter case of the words.
+    template <class Function>
+    void FindCandidates(
+        const std::string& lowerInput,
+        int editDistance,
+        Function callback) const;
+
+private:
+    void BuildFromSortedWords(const std::vector<std::string>& sortedWords);
+
+    uint32_t GetEdgeCount(uint32_t node) const
+    {
+        return nodeFirstEdges[node + 1] - nodeFirstEdges[node];
+    }
+
+private:
+    // NOTE:
+    // Node `i` owns the edges in [nodeFirstEdges[i], nodeFirstEdges[i + 1]),
+    // sorted by label. The root is the last node because the nodes are
+    // stored in the order the construction finishes them.
+    std::vector<uint32_t> nodeFirstEdges;
+    std::vector<bool> finalFlags;
+    std::vector<char> edgeLabels;
+    std::vector<uint32_t> edgeTargets;
+};
+
+///@brief The words of the DAWG engine.
+///
+/// The copies of a dictionary share the graph of the words as of the last
+/// merge. The words added since then are kept in a second, small graph,
+/// and the words removed since then are filtered out of the lookups, so an
+/// update only rebuilds the small graph until it is worth a merge.
+class DawgDictionary final {
+public:
+    static constexpr int maxEditDistance = 2;
+
+    void AddWord(const std::string& word);
+
+    void RemoveWord(const std::string& word);
+
+    ///@brief Applies the words added or removed since the last build. The
+    /// lookups must not be called while words are pending.
+    void Build();
+
+    bool ExistsExactly(const std::string& word) const;
+
+    ///@brief Calls `callback(word, distance)` for each word within
+    /// `editDistance` of `lowerInput`, ignoring the letter case of the words.
+    template <class Function>
+    void FindCandidates(
+        const std::string& lowerInput,
+        int editDistance,
+        Function callback) const;
+
+private:
+    void MergeGraphs();
+
+private:
+    struct PendingWord {
+        std::string word;
+        bool removed;
+    };
+
+    std::shared_ptr<const DawgGraph> mergedGraph = std::make_shared<const DawgGraph>(std::vector<std::string>{});
+    std::size_t mergedWordCount = 0;
+
+    ///@brief Words of `mergedGraph` removed since the last merge.
+    std::unordered_set<std::string> removedWords;
+
+    ///@brief Sorted words added since the last merge, which are not in
+    /// `mergedGraph`, and their graph.
+    std::vector<std::string> addedWords;
+    std::shared_ptr<const DawgGraph> addedGraph = mergedGraph;
+
+    std::vector<PendingWord> pendingWords;
+};
+
+constexpr int DawgDictionary::maxEditDistance;
+
+void DawgDictionary::AddWord(const std::string& word)
+{
+    assert(!word.empty());
+    pendingWords.push_back(PendingWord{word, false});
+}
+
+void DawgDictionary::RemoveWord(const std::string& word)
+{
+    pendingWords.push_back(PendingWord{word, true});
+}
+
+void DawgGraph::CollectWords(std::vector<std::string> & words) const
+{
+    if (nodeFirstEdges.empty()) {
+        return;
+    }
+
+    // NOTE: The labels are sorted, so a depth-first walk yields sorted words.
+    struct Frame {
+        uint32_t edge;
+        uint32_t last;
+    };
+    const auto root = static_cast<uint32_t>(nodeFirstEdges.size() - 2);
+    std::vector<Frame> stack;
+    stack.push_back(Frame{nodeFirstEdges[root], nodeFirstEdges[root + 1]});
+    std::string word;
+    while (!stack.empty()) {
+        auto & frame = stack.back();
+        if (frame.edge == frame.last) {
+            stack.pop_back();
+            if (!word.empty()) {
+                word.pop_back();
+            }
+            continue;
+        }
+        const auto edge = frame.edge++;
+        const auto target = edgeTargets[edge];
+        word += edgeLabels[edge];
+        if (finalFlags[target]) {
+            words.push_back(word);
+        }
+        stack.push_back(Frame{nodeFirstEdges[target], nodeFirstEdges[target + 1]});
+    }
+}
+
+void DawgGraph::BuildFromSortedWords(const std::vector<std::string>& sortedWords)
+{
+    assert(std::is_sorted(std::begin(sortedWords), std::end(sortedWords)));
+
+    nodeFirstEdges.assign(1, 0);
+    finalFlags.clear();
+    edgeLabels.clear();
+    edgeTargets.clear();
+
+    // NOTE:
+    // Only the nodes on the path of the previous word are still mutable.
+    // When the next word branches off, the nodes below the branch are
+    // finished: each one is replaced by an equivalent finished node if one
+    // exists, or appended to the node arrays otherwise.
+    struct PathNode {
+        std::vector<std::pair<char, uint32_t>> edges;
+        bool isFinal = false;
+    };
+    std::vector<PathNode> path(1);
+
+    // NOTE: Open addressing set of the finished nodes, hashed by content.
+    std::vector<uint32_t> registry(1024, std::numeric_limits<uint32_t>::max());
+    const auto emptySlot = std::numeric_limits<uint32_t>::max();
+    std::size_t registeredCount = 0;
+
+    auto hashNode = [](const PathNode& node) {
+        uint64_t hash = node.isFinal ? 1 : 0;
+        for (auto & edge : node.edges) {
+            hash = (hash ^ static_cast<uint8_t>(edge.first)) * 1099511628211ULL;
+            hash = (hash ^ edge.second) * 1099511628211ULL;
+        }
+        return hash;
+    };
+    auto equals = [&](const PathNode& node, uint32_t id) {
+        if ((finalFlags[id] != node.isFinal) || (GetEdgeCount(id) != node.edges.size())) {
+            return false;
+        }
+        auto edge = nodeFirstEdges[id];
+        for (auto & pair : node.edges) {
+            if ((edgeLabels[edge] != pair.first) || (edgeTargets[edge] != pair.second)) {
+                return false;
+            }
+            ++edge;
+        }
+        return true;
+    };
+    auto append = [&](const PathNode& node) {
+        const auto id = static_cast<uint32_t>(finalFlags.size());
+        finalFlags.push_back(node.isFinal);
+        for (auto & pair : node.edges) {
+            edgeLabels.push_back(pair.first);
+            edgeTargets.push_back(pair.second);
+        }
+        nodeFirstEdges.push_back(static_cast<uint32_t>(edgeLabels.size()));
+        return id;
+    };
+    auto findOrAppend = [&](const PathNode& node) {
+        const auto mask = registry.size() - 1;
+        const auto hash = hashNode(node);
+        auto slot = static_cast<std::size_t>(hash) & mask;
+        for (; registry[slot] != emptySlot; slot = (slot + 1) & mask) {
+            if (equals(node, registry[slot])) {
+                return registry[slot];
+            }
+        }
+        const auto id = append(node);
+        registry[slot] = id;
+        ++registeredCount;
+        if (registeredCount * 2 > registry.size()) {
+            // NOTE: Rehashes the finished nodes, which are immutable.
+            std::vector<uint32_t> newRegistry(registry.size() * 2, emptySlot);
+            const auto newMask = newRegistry.size() - 1;
+            PathNode finished;
+            for (auto registered : registry) {
+                if (registered == emptySlot) {
+                    continue;
+                }
+                finished.isFinal = finalFlags[registered];
+                finished.edges.clear();
+                for (auto e = nodeFirstEdges[registered]; e < nodeFirstEdges[registered + 1]; ++e) {
+                    finished.edges.emplace_back(edgeLabels[e], edgeTargets[e]);
+                }
+                auto newSlot = static_cast<std::size_t>(hashNode(finished)) & newMask;
+                while (newRegistry[newSlot] != emptySlot) {
+                    newSlot = (newSlot + 1) & newMask;
+                }
+                newRegistry[newSlot] = registered;
+            }
+            std::swap(registry, newRegistry);
+        }
+        return id;
+    };
+
+    // NOTE: Finishes the path nodes deeper than `depth`.
+    auto minimize = [&](std::size_t depth) {
+        while (path.size() > depth + 1) {
+            const auto id = findOrAppend(path.back());
+            path.pop_back();
+            assert(!path.back().edges.empty());
+            path.back().edges.back().second = id;
+        }
+    };
+
+    const std::string* previous = nullptr;
+    for (auto & word : sortedWords) {
+        if (word.empty() || ((previous != nullptr) && (*previous == word))) {
+            continue;
+        }
+        std::size_t prefixLength = 0;
+        if (previous != nullptr) {
+            const auto maxLength = std::min(previous->size(), word.size());
+            while ((prefixLength < maxLength) && ((*previous)[prefixLength] == word[prefixLength])) {
+                ++prefixLength;
+            }
+        }
+        minimize(prefixLength);
+        for (auto i = prefixLength; i < word.size(); ++i) {
+            path.back().edges.emplace_back(word[i], 0);
+            path.emplace_back();
+        }
+        path.back().isFinal = true;
+        previous = &word;
+    }
+    minimize(0);
+
+    // NOTE: The root is appended last without looking for an equivalent node.
+    append(path.front());
+}
+
+bool DawgGraph::Contains(const std::string& word) const
+{
+    if (nodeFirstEdges.empty()) {
+        return false;
+    }
+    auto node = static_cast<uint32_t>(nodeFirstEdges.size() - 2);
+    for (auto c : word) {
+        const auto first = std::begin(edgeLabels) + nodeFirstEdges[node];
+        const auto last = std::begin(edgeLabels) + nodeFirstEdges[node + 1];
+        const auto edge = std::lower_bound(first, last, c, [](char a, char b) {
+            return static_cast<uint8_t>(a) < static_cast<uint8_t>(b);
+        });
+        if ((edge == last) || (*edge != c)) {
+            return false;
+        }
+        node = edgeTargets[std::distance(std::begin(edgeLabels), edge)];
+    }
+    return finalFlags[node];
+}
+
+template <class Function>
+void DawgGraph::FindCandidates(
+    const std::string& lowerInput,
+    int editDistance,
+    Function callback) const
+{
+    if (nodeFirstEdges.empty()) {
+        return;
+    }
+
+    // NOTE:
+    // Simulates the Levenshtein automaton of `lowerInput` with degree
+    // `editDistance` while walking the graph. The automaton state at depth
+    // `d` is the band [d - editDistance, d + editDistance] of the edit
+    // distance row, since the cells outside the band always exceed
+    // `editDistance`. A node is pruned, together with all the words below
+    // it, as soon as every cell in the band does.
+    const auto inputLength = static_cast<int>(lowerInput.size());
+    const auto rowSize = inputLength + 1;
+    const auto tooFar = editDistance + 1;
+    const auto maxDepth = inputLength + editDistance;
+
+    std::vector<int> rows(static_cast<std::size_t>(rowSize) * (maxDepth + 1), tooFar);
+    for (int j = 0; j <= std::min(editDistance, inputLength); ++j) {
+        rows[j] = j;
+    }
+
+    // NOTE:
+    // Every label that matches no input character in the band leads to
+    // the same state. When that state is pruned, only the edges whose
+    // labels are in `bandLabels` of the depth need to be followed.
+    using LabelSet = std::array<uint64_t, 4>;
+    std::vector<LabelSet> bandLabels(maxDepth + 1, LabelSet{{0, 0, 0, 0}});
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+        auto & labels = bandLabels[depth];
+        const auto first = std::max(depth - editDistance, 1);
+        const auto last = std::min(depth + editDistance, inputLength);
+        for (int j = first; j <= last; ++j) {
+            const auto c = static_cast<uint8_t>(lowerInput[j - 1]);
+            labels[c >> 6] |= (static_cast<uint64_t>(1) << (c & 63));
+            if ((c >= 'a') && (c <= 'z')) {
+                const auto upper = static_cast<uint8_t>(c - 'a' + 'A');
+                labels[upper >> 6] |= (static_cast<uint64_t>(1) << (upper & 63));
+            }
+        }
+    }
+
+    // NOTE: Computes the row at `depth` for `label`, and returns its minimum.
+    auto computeRow = [&](int depth, char label, int* row) {
+        const auto previousRow = rows.data() + static_cast<std::size_t>(rowSize) * (depth - 1);
+        const auto first = std::max(depth - editDistance, 0);
+        const auto last = std::min(depth + editDistance, inputLength);
+        int left = tooFar;
+        int minDistance = tooFar;
+        for (int j = first; j <= last; ++j) {
+            int distance = depth;
+            if (j > 0) {
+                const auto substitution = previousRow[j - 1] + ((lowerInput[j - 1] == label) ? 0 : 1);
+                distance = std::min({substitution, previousRow[j] + 1, left + 1});
+            }
+            left = std::min(distance, tooFar);
+            if (row != nullptr) {
+                row[j] = left;
+            }
+            minDistance = std::min(minDistance, left);
+        }
+        return minDistance;
+    };
+
+    // NOTE: A zero byte is never in a word, so it matches no input character.
+    auto acceptsAnyLabel = [&](int depth) {
+        return (depth <= maxDepth) && (computeRow(depth, '\0', nullptr) <= editDistance);
+    };
+
+    struct Frame {
+        uint32_t edge;
+        uint32_t last;
+        bool acceptsAnyLabel;
+    };
+    const auto root = static_cast<uint32_t>(nodeFirstEdges.size() - 2);
+    std::vector<Frame> stack;
+    stack.push_back(Frame{nodeFirstEdges[root], nodeFirstEdges[root + 1], acceptsAnyLabel(1)});
+    std::string word;
+
+    while (!stack.empty()) {
+        auto & frame = stack.back();
+        if (frame.edge == frame.last) {
+            stack.pop_back();
+            if (!word.empty()) {
+                word.pop_back();
+            }
+            continue;
+        }
+        const auto edge = frame.edge++;
+        const auto depth = static_cast<int>(stack.size());
+        if (depth > maxDepth) {
+            continue;
+        }
+
+        const auto originalLabel = static_cast<uint8_t>(edgeLabels[edge]);
+        const auto& labels = bandLabels[depth];
+        if (!frame.acceptsAnyLabel && (((labels[originalLabel >> 6] >> (originalLabel & 63)) & 1) == 0)) {
+            continue;
+        }
+
+        auto label = edgeLabels[edge];
+        if ((label >= 'A') && (label <= 'Z')) {
+            label = static_cast<char>(label - 'A' + 'a');
+        }
+        const auto row = rows.data() + static_cast<std::size_t>(rowSize) * depth;
+        const auto first = std::max(depth - editDistance, 0);
+        const auto last = std::min(depth + editDistance, inputLength);
+
+        // NOTE: The cells next to the band may hold values from another branch.
+        if (first > 0) {
+            row[first - 1] = tooFar;
+        }
+        if (last < inputLength) {
+            row[last + 1] = tooFar;
+        }
+        if (computeRow(depth, label, row) > editDistance) {
+            continue;
+        }
+
+        const auto target = edgeTargets[edge];
+        word += edgeLabels[edge];
+        if (finalFlags[target] && (last == inputLength) && (row[inputLength] <= editDistance)) {
+            callback(word, row[inputLength]);
+        }
+        stack.push_back(Frame{nodeFirstEdges[target], nodeFirstEdges[target + 1], acceptsAnyLabel(depth + 1)});
+    }
+}
+
+void DawgDictionary::Build()
+{
+    if (pendingWords.empty()) {
+        return;
+    }
+
+    // NOTE: The last operation on each word wins.
+    std::stable_sort(std::begin(pendingWords), std::end(pendingWords),
+        [](const PendingWord& a, const PendingWord& b) { return a.word < b.word; });
+
+    std::vector<std::string> words;
+    words.reserve(addedWords.size() + pendingWords.size());
+    auto current = std::begin(addedWords);
+    auto pending = std::begin(pendingWords);
+    while (pending != std::end(pendingWords)) {
+        auto last = std::next(pending);
+        while ((last != std::end(pendingWords)) && (last->word == pending->word)) {
+            ++last;
+        }
+        const auto& change = *std::prev(last);
+        for (; (current != std::end(addedWords)) && (*current < change.word); ++current) {
+            words.push_back(std::move(*current));
+        }
+        if ((current != std::end(addedWords)) && (*current == change.word)) {
+            ++current;
+        }
+        if (mergedGraph->Contains(change.word)) {
+            if (change.removed) {
+                removedWords.insert(change.word);
+            }
+            else {
+                removedWords.erase(change.word);
+            }
+        }
+        else if (!change.removed) {
+            words.push_back(change.word);
+        }
+        pending = last;
+    }
+    for (; current != std::end(addedWords); ++current) {
+        words.push_back(std::move(*current));
+    }
+    std::swap(addedWords, words);
+    pendingWords.clear();
+    pendingWords.shrink_to_fit();
+
+    // NOTE:
+    // A merge rebuilds the whole graph, so it waits until the changes are
+    // an eighth of the merged words. Until then, only the graph of the
+    // added words is rebuilt.
+    if ((addedWords.size() + removedWords.size()) * 8 < mergedWordCount) {
+        addedGraph = std::make_shared<const DawgGraph>(addedWords);
+        return;
+    }
+    MergeGraphs();
+}
+
+void DawgDictionary::MergeGraphs()
+{
+    std::vector<std::string> mergedWords;
+    mergedGraph->CollectWords(mergedWords);
+    if (!removedWords.empty()) {
+        mergedWords.erase(std::remove_if(std::begin(mergedWords), std::end(mergedWords),
+            [&](const std::string& word) { return removedWords.count(word) > 0; }),
+            std::end(mergedWords));
+    }
+
+    // NOTE: The added words are never in the merged graph.
+    std::vector<std::string> words;
+    words.reserve(mergedWords.size() + addedWords.size());
+    std::merge(
+        std::make_move_iterator(std::begin(mergedWords)), std::make_move_iterator(std::end(mergedWords)),
+        std::make_move_iterator(std::begin(addedWords)), std::make_move_iterator(std::end(addedWords)),
+        std::back_inserter(words));
+
+    mergedGraph = std::make_shared<const DawgGraph>(words);
+    mergedWordCount = words.size();
+    removedWords.clear();
+    addedWords.clear();
+    addedGraph = std::make_shared<const DawgGraph>(addedWords);
+}
+
+bool DawgDictionary::ExistsExactly(const std::string& word) const
+{
+    assert(pendingWords.empty());
+    if (mergedGraph->Contains(word)) {
+        return removedWords.count(word) == 0;
     }
-    return LetterCase::LowerCase;
+    return std::binary_search(std::begin(addedWords), std::end(addedWords), word);
 }
 
-#if 0
-void TestCase_GetLetterCase()
+template <class Function>
+void DawgDictionary::FindCandidates(
+    const std::string& lowerInput,
+    int editDistance,
+    Function callback) const
 {
-    assert(GetLetterCase("Word") == LetterCase::UpperCamelCase);
-    assert(GetLetterCase("WORD") == LetterCase::UpperCase);
-    assert(GetLetterCase("word") == LetterCase::LowerCase);
+    assert(pendingWords.empty());
+    if (removedWords.empty()) {
+        mergedGraph->FindCandidates(lowerInput, editDistance, callback);
+    }
+    else {
+        mergedGraph->FindCandidates(lowerInput, editDistance, [&](const std::string& word, int distance) {
+            if (removedWords.count(word) == 0) {
+                callback(word, distance);
+            }
+        });
+    }
+    addedGraph->FindCandidates(lowerInput, editDistance, callback);
 }
-#endif
 
-void TransformLetterCase(std::string & word, LetterCase letterCase)
+SpellCheckResultInternal SuggestInternal(
+    const std::string& input,
+    const DawgDictionary& dictionary)
 {
-    switch (letterCase) {
-    case LetterCase::LowerCase:
-        for (auto & c : word) {
-            c = ::tolower(c);
+    SpellCheckResultInternal result;
+    result.correctlySpelled = false;
+
+    const auto inputWordSize = StringLength(input);
+    const auto sizeAsDouble = static_cast<double>(inputWordSize);
+    const double similarityThreshold = std::max((sizeAsDouble - std::min(sizeAsDouble, 2.0)) / sizeAsDouble, 0.5);
+
+    const auto lowerInput = StringHelper::toLower(input);
+    if (dictionary.ExistsExactly(input) || dictionary.ExistsExactly(lowerInput)) {
+        // exaxt matching
+        SpellSuggestion suggestion;
+        suggestion.word = dictionary.ExistsExactly(input) ? input : lowerInput;
+        suggestion.similarity = 1.0;
+        result.suggestions.push_back(std::move(suggestion));
+        result.correctlySpelled = true;
+        return result;
+    }
+
+    // NOTE:
+    // Only the candidates at the closest edit distance are kept, the same
+    // as the symmetric delete engine. The automaton is much smaller for a
+    // lower distance, so each distance is searched in turn and the search
+    // stops at the first one with a suggestion. The closer candidates seen
+    // again in a later search have already failed the similarity check.
+    int bestDistance = DawgDictionary::maxEditDistance;
+    int minDistance = 0;
+
+    auto checkCandidate = [&](const std::string& word, int distance) {
+        if (result.correctlySpelled || (distance < minDistance) || (distance > bestDistance)) {
+            return;
         }
-        break;
-    case LetterCase::UpperCase:
-        for (auto & c : word) {
-            c = ::toupper(c);
+        const auto similarity = closestMatchFuzzySimilarity(
+            input, word, static_cast<int>(input.size() + word.size()), similarityThreshold);
+        if (similarity == 1.0) {
+            // exaxt matching
+            SpellSuggestion suggestion;
+            suggestion.word = word;
+            suggestion.similarity = similarity;
+            result.suggestions.insert(std::begin(result.suggestions), std::move(suggestion));
+            result.correctlySpelled = true;
         }
-        break;
-    case LetterCase::UpperCamelCase: {
-        for (auto & c : word) {
-            c = ::tolower(c);
+        else if (similarity >= similarityThreshold) {
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                result.suggestions.clear();
+            }
+            SpellSuggestion suggestion;
+            suggestion.word = word;
+            suggestion.similarity = similarity;
+            result.suggestions.push_back(std::move(suggestion));
         }
-        if (!word.empty()) {
-            auto & c = word.front();
-            c = ::toupper(c);
+    };
+
+    for (int editDistance = 1; editDistance <= DawgDictionary::maxEditDistance; ++editDistance) {
+        dictionary.FindCandidates(lowerInput, editDistance, checkCandidate);
+        if (!result.suggestions.empty()) {
+            break;
         }
-        break;
+        minDistance = editDistance + 1;
     }
+    return result;
+}
+
+Optional<SpellSuggestion> ExistWordInternal(
+    const std::string& input,
+    const DawgDictionary& dictionary)
+{
+    const std::size_t gapSizeThreshold = 1;
+    const int editDistance = 1;
+    double similarityThreshold = 0.8;
+
+    const auto inputWordSize = StringLength(input);
+    const auto lowerInput = StringHelper::toLower(input);
+    if (dictionary.ExistsExactly(input) || dictionary.ExistsExactly(lowerInput)) {
+        SpellSuggestion suggestion;
+        suggestion.word = dictionary.ExistsExactly(input) ? input : lowerInput;
+        suggestion.similarity = 1.0;
+        return suggestion;
     }
+
+    Optional<SpellSuggestion> currentSuggestion;
+    bool exactMatching = false;
+
+    dictionary.FindCandidates(lowerInput, editDistance,
+        [&](const std::string& word, int) {
+            if (exactMatching || (ComputeGapSize(StringLength(word), inputWordSize) > gapSizeThreshold)) {
+                return;
+            }
+            const auto similarity = closestMatchFuzzySimilarity(input, word, editDistance, similarityThreshold);
+            if (similarity == 1.0) {
+                // exaxt matching
+                SpellSuggestion suggestion;
+                suggestion.word = word;
+                suggestion.similarity = similarity;
+                currentSuggestion = std::move(suggestion);
+                exactMatching = true;
+            }
+            else if (similarity >= similarityThreshold) {
+                similarityThreshold = similarity;
+                SpellSuggestion suggestion;
+                suggestion.word = word;
+                suggestion.similarity = similarity;
+                currentSuggestion = std::move(suggestion);
+            }
+        });
+    return currentSuggestion;
 }
 
+template <class Dictionary>
 SpellCheckResultInternal SuggestLetterCase(
     const std::string& word,
-    const std::unordered_map<uint32_t, std::vector<std::string>>& hashedDictionary)
+    const Dictionary& dictionary)
 {
-    auto result = SuggestInternal(word, hashedDictionary);
+    auto result = SuggestInternal(word, dictionary);
     if (result.suggestions.empty()) {
         return result;
     }
@@ -464,17 +3111,10 @@ SpellCheckResultInternal SuggestLetterCase(
     return result;
 }
 
-template <typename T>
-void ResizeSuggestions(T & suggestions, std::size_t elementCount)
-{
-    if (suggestions.size() > elementCount) {
-        suggestions.resize(elementCount);
-    }
-}
-
+template <class Dictionary>
 void SeparateWords(
     const std::string& word,
-    const std::unordered_map<uint32_t, std::vector<std::string>>& hashedDictionary,
+    const Dictionary& dictionary,
     std::vector<SpellSuggestion> & suggestions)
 {
     constexpr std::size_t prefixMinSize = 2;
@@ -493,11 +3133,11 @@ void SeparateWords(
         const auto prefix = word.substr(0, separator);
         const auto suffix = word.substr(separator);
 
-        auto prefixSuggestion = ExistWordSignatureHashingingInternal(prefix, hashedDictionary);
+        auto prefixSuggestion = ExistWordInternal(prefix, dictionary);
         if (!prefixSuggestion) {
             continue;
         }
-        auto suffixSuggestion = ExistWordSignatureHashingingInternal(suffix, hashedDictionary);
+        auto suffixSuggestion = ExistWordInternal(suffix, dictionary);
         if (!suffixSuggestion) {
             continue;
         }
@@ -656,9 +3296,10 @@ std::vector<PartOfIdentifier> parseIdentifier(const std::string& text)
     return words;
 }
 
+template <class Dictionary>
 void ParseIdentifier(
     const std::string& word,
-    const std::unordered_map<uint32_t, std::vector<std::string>>& hashedDictionary,
+    const Dictionary& dictionary,
     SpellCheckResultInternal & result)
 {
     bool exactMatching = true;
@@ -685,7 +3326,7 @@ void ParseIdentifier(
             concatnate(p.word);
             continue;
         }
-        auto result1 = SuggestLetterCase(p.word, hashedDictionary);
+        auto result1 = SuggestLetterCase(p.word, dictionary);
         if (result1.correctlySpelled) {
             concatnate(p.word);
             misspellingFound = true;
@@ -698,8 +3339,7 @@ void ParseIdentifier(
         }
 
         misspellingFound = true;
-        SortSuggestions(p.word, result1.suggestions);
-        ResizeSuggestions(result1.suggestions, 2);
+        SortSuggestions(p.word, result1.suggestions, 2);
 
         // NOTE: Generating combinations
         std::vector<std::string> tempSuggestions;
@@ -726,38 +3366,446 @@ void ParseIdentifier(
     result.correctlySpelled = exactMatching;
 }
 
-SpellCheckResult SpellCheckerSignatureHashing::Suggest(const std::string& word)
+template <class Dictionary>
+SpellCheckResult SuggestWithDictionary(const std::string& word, const Dictionary& dictionary)
 {
     constexpr std::size_t maxSuggestions = 8;
 
-    auto result = SuggestLetterCase(word, hashedDictionary);
+    const auto stats = GetStats(dictionary);
+    auto rankSuggestions = [&](SpellCheckResultInternal & result) {
+        StageTimer timer(stats, &SpellCheckerStats::rankingSeconds);
+        SortSuggestions(word, result.suggestions, maxSuggestions);
+    };
+
+    SpellCheckResultInternal result;
+    {
+        StageTimer timer(stats, &SpellCheckerStats::probeSeconds);
+        result = SuggestLetterCase(word, dictionary);
+    }
     if (result.correctlySpelled) {
-        SortSuggestions(word, result.suggestions);
-        ResizeSuggestions(result.suggestions, maxSuggestions);
+        rankSuggestions(result);
         return ConvertToSpellCheckResult(result);
     }
 
-    ParseIdentifier(word, hashedDictionary, result);
+    {
+        StageTimer timer(stats, &SpellCheckerStats::identifierSeconds);
+        ParseIdentifier(word, dictionary, result);
+    }
 
     if (result.correctlySpelled) {
-        SortSuggestions(word, result.suggestions);
-        ResizeSuggestions(result.suggestions, maxSuggestions);
+        rankSuggestions(result);
         return ConvertToSpellCheckResult(result);
     }
 
-    SeparateWords(word, hashedDictionary, result.suggestions);
+    {
+        StageTimer timer(stats, &SpellCheckerStats::separationSeconds);
+        SeparateWords(word, dictionary, result.suggestions);
+    }
 
-    SortSuggestions(word, result.suggestions);
-    ResizeSuggestions(result.suggestions, maxSuggestions);
+    rankSuggestions(result);
 
     return ConvertToSpellCheckResult(result);
 }
 
+SpellCheckResult SpellCheckerSignatureHashing::Suggest(const std::string& word)
+{
+    SpellCheckerStats localStats;
+    const auto layer = layers.Acquire();
+    const auto dictionary = MakeDictionary(*layer, isStatsEnabled ? &localStats : nullptr);
+    auto result = SuggestWithDictionary(word, dictionary);
+    if (isStatsEnabled) {
+        localStats.queryCount = 1;
+        MergeStats(localStats);
+    }
+    return result;
+}
+
+std::vector<SpellCheckResult> SpellCheckerSignatureHashing::SuggestWords(
+    const std::vector<std::string>& words, int threadCount)
+{
+    // NOTE: All the words are checked against the same snapshot.
+    const auto layer = layers.Acquire();
+    const auto sharedDictionary = MakeDictionary(*layer, nullptr);
+
+    // NOTE: Sorting by signature keeps the words that share buckets on the same thread.
+    auto uniqueWords = UniqueWords(words);
+    std::vector<std::string> sortedWords = uniqueWords;
+    std::stable_sort(std::begin(sortedWords), std::end(sortedWords),
+        [](const std::string& a, const std::string& b) {
+            return SignatureHashingFromAsciiAlphabet(a) < SignatureHashingFromAsciiAlphabet(b);
+        });
+
+    std::vector<SpellCheckResult> uniqueResults(uniqueWords.size());
+    const auto partCount = std::max<std::size_t>(1,
+        std::min<std::size_t>(static_cast<std::size_t>(std::max(threadCount, 1)), sortedWords.size()));
+    ParallelFor(threadCount, partCount, [&](int, std::size_t part) {
+        const auto first = sortedWords.size() * part / partCount;
+        const auto last = sortedWords.size() * (part + 1) / partCount;
+        SpellCheckerStats localStats;
+        auto dictionary = sharedDictionary;
+        dictionary.stats = isStatsEnabled ? &localStats : nullptr;
+
+        auto resultOf = [&](const std::string& word) -> SpellCheckResult& {
+            auto iter = std::lower_bound(std::begin(uniqueWords), std::end(uniqueWords), word);
+            assert(iter != std::end(uniqueWords) && *iter == word);
+            return uniqueResults[std::distance(std::begin(uniqueWords), iter)];
+        };
+
+        std::vector<SignatureHashingProbe> probes;
+        probes.reserve(last - first);
+        for (auto i = first; i < last; ++i) {
+            // NOTE: The correctly spelled words don't need the batched search.
+            if (FindExactWord(sortedWords[i], dictionary)) {
+                resultOf(sortedWords[i]) = SuggestWithDictionary(sortedWords[i], dictionary);
+                continue;
+            }
+            probes.push_back(MakeSignatureHashingProbe(sortedWords[i]));
+        }
+        {
+            StageTimer timer(dictionary.stats, &SpellCheckerStats::probeSeconds);
+            SuggestInternalBatch(probes, dictionary);
+        }
+
+        for (auto & probe : probes) {
+            const auto& word = *probe.input;
+            const PrecomputedSignatureHashingDictionary precomputed = {
+                dictionary,
+                word,
+                probe.result,
+            };
+            resultOf(word) = SuggestWithDictionary(word, precomputed);
+        }
+        if (isStatsEnabled) {
+            localStats.queryCount = last - first;
+            MergeStats(localStats);
+        }
+    });
+    return ExpandUniqueResults(words, uniqueWords, uniqueResults);
+}
+
+void SpellCheckerSignatureHashing::SetStatsEnabled(bool enabled)
+{
+    isStatsEnabled = enabled;
+}
+
+SpellCheckerStats SpellCheckerSignatureHashing::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+void SpellCheckerSignatureHashing::MergeStats(const SpellCheckerStats& localStats)
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats += localStats;
+}
+
+class SpellCheckerSymmetricDelete final : public SpellChecker {
+public:
+    SpellCheckerSymmetricDelete();
+
+    SpellCheckResult Suggest(const std::string& word);
+
+    void AddWord(const std::string& word);
+
+    void AddWords(const std::vector<std::string>& words);
+
+    void RemoveWord(const std::string& word);
+
+    void UpdateWords(
+        const std::vector<std::string>& addedWords,
+        const std::vector<std::string>& removedWords);
+
+private:
+    static void ApplyChanges(
+        SymmetricDeleteDictionary& dictionary, const std::vector<WordChanges>& changes);
+
+    DictionarySnapshots<SymmetricDeleteDictionary> dictionaries;
+};
+
+SpellCheckerSymmetricDelete::SpellCheckerSymmetricDelete()
+    : dictionaries(&SpellCheckerSymmetricDelete::ApplyChanges)
+{
+}
+
+SpellCheckerStats* GetStats(const SymmetricDeleteDictionary&)
+{
+    return nullptr;
+}
+
+SpellCheckResult SpellCheckerSymmetricDelete::Suggest(const std::string& word)
+{
+    const auto dictionary = dictionaries.Acquire();
+    return SuggestWithDictionary(word, *dictionary);
+}
+
+void SpellCheckerSymmetricDelete::AddWord(const std::string& word)
+{
+    UpdateWords({word}, {});
+}
+
+void SpellCheckerSymmetricDelete::AddWords(const std::vector<std::string>& words)
+{
+    UpdateWords(words, {});
+}
+
+void SpellCheckerSymmetricDelete::RemoveWord(const std::string& word)
+{
+    UpdateWords({}, {word});
+}
+
+void SpellCheckerSymmetricDelete::UpdateWords(
+    const std::vector<std::string>& addedWords,
+    const std::vector<std::string>& removedWords)
+{
+    dictionaries.Update(WordChanges{addedWords, removedWords});
+}
+
+void SpellCheckerSymmetricDelete::ApplyChanges(
+    SymmetricDeleteDictionary& dictionary, const std::vector<WordChanges>& changes)
+{
+    for (auto & change : changes) {
+        for (auto & word : change.addedWords) {
+            dictionary.AddWord(word);
+        }
+        for (auto & word : change.removedWords) {
+            dictionary.RemoveWord(word);
+        }
+    }
+    // NOTE: Rebuilding the index is the expensive part, so it runs once
+    // for all the queued changes.
+    dictionary.BuildDeletionIndex();
+}
+
+class SpellCheckerDawg final : public SpellChecker {
+public:
+    SpellCheckerDawg();
+
+    SpellCheckResult Suggest(const std::string& word);
+
+    void AddWord(const std::string& word);
+
+    void AddWords(const std::vector<std::string>& words);
+
+    void RemoveWord(const std::string& word);
+
+    void UpdateWords(
+        const std::vector<std::string>& addedWords,
+        const std::vector<std::string>& removedWords);
+
+private:
+    static void ApplyChanges(
+        DawgDictionary& dictionary, const std::vector<WordChanges>& changes);
+
+    DictionarySnapshots<DawgDictionary> dictionaries;
+};
+
+SpellCheckerDawg::SpellCheckerDawg()
+    : dictionaries(&SpellCheckerDawg::ApplyChanges)
+{
+}
+
+SpellCheckerStats* GetStats(const DawgDictionary&)
+{
+    return nullptr;
+}
+
+SpellCheckResult SpellCheckerDawg::Suggest(const std::string& word)
+{
+    const auto dictionary = dictionaries.Acquire();
+    return SuggestWithDictionary(word, *dictionary);
+}
+
+void SpellCheckerDawg::AddWord(const std::string& word)
+{
+    UpdateWords({word}, {});
+}
+
+void SpellCheckerDawg::AddWords(const std::vector<std::string>& words)
+{
+    UpdateWords(words, {});
+}
+
+void SpellCheckerDawg::RemoveWord(const std::string& word)
+{
+    UpdateWords({}, {word});
+}
+
+void SpellCheckerDawg::UpdateWords(
+    const std::vector<std::string>& addedWords,
+    const std::vector<std::string>& removedWords)
+{
+    dictionaries.Update(WordChanges{addedWords, removedWords});
+}
+
+void SpellCheckerDawg::ApplyChanges(
+    DawgDictionary& dictionary, const std::vector<WordChanges>& changes)
+{
+    for (auto & change : changes) {
+        for (auto & word : change.addedWords) {
+            dictionary.AddWord(word);
+        }
+        for (auto & word : change.removedWords) {
+            dictionary.RemoveWord(word);
+        }
+    }
+    // NOTE: Rebuilding the index is the expensive part, so it runs once
+    // for all the queued changes.
+    dictionary.Build();
+}
+
 } // unnamed namespace
 
+SpellCheckerStats& operator+=(SpellCheckerStats& stats, const SpellCheckerStats& other)
+{
+    stats.queryCount += other.queryCount;
+    stats.exactHitCount += other.exactHitCount;
+    stats.bucketLookupCount += other.bucketLookupCount;
+    stats.bucketHitCount += other.bucketHitCount;
+    stats.candidateCount += other.candidateCount;
+    stats.scoredCandidateCount += other.scoredCandidateCount;
+    stats.probeSeconds += other.probeSeconds;
+    stats.identifierSeconds += other.identifierSeconds;
+    stats.separationSeconds += other.separationSeconds;
+    stats.rankingSeconds += other.rankingSeconds;
+    return stats;
+}
+
+void SpellChecker::AddWords(const std::vector<std::string>& words)
+{
+    for (auto & word : words) {
+        AddWord(word);
+    }
+}
+
+void SpellChecker::UpdateWords(
+    const std::vector<std::string>& addedWords,
+    const std::vector<std::string>& removedWords)
+{
+    AddWords(addedWords);
+    for (auto & word : removedWords) {
+        RemoveWord(word);
+    }
+}
+
+std::vector<SpellCheckResult> SpellChecker::SuggestWords(
+    const std::vector<std::string>& words, int threadCount)
+{
+    const auto uniqueWords = UniqueWords(words);
+    std::vector<SpellCheckResult> uniqueResults(uniqueWords.size());
+    ParallelFor(threadCount, uniqueWords.size(), [&](int, std::size_t index) {
+        uniqueResults[index] = Suggest(uniqueWords[index]);
+    });
+    return ExpandUniqueResults(words, uniqueWords, uniqueResults);
+}
+
+void SpellChecker::SetStatsEnabled(bool)
+{
+}
+
+SpellCheckerStats SpellChecker::GetStats() const
+{
+    return {};
+}
+
 std::shared_ptr<SpellChecker> SpellCheckerFactory::Create()
 {
+    return Create(SpellCheckerEngine::SignatureHashing);
+}
+
+std::shared_ptr<SpellChecker> SpellCheckerFactory::Create(SpellCheckerEngine engine)
+{
+    switch (engine) {
+    case SpellCheckerEngine::SignatureHashing:
+        return std::make_shared<SpellCheckerSignatureHashing>();
+    case SpellCheckerEngine::SymmetricDelete:
+        return std::make_shared<SpellCheckerSymmetricDelete>();
+    case SpellCheckerEngine::Dawg:
+        return std::make_shared<SpellCheckerDawg>();
+    }
     return std::make_shared<SpellCheckerSignatureHashing>();
 }
 
+class SpellCheckerDictionary final {
+public:
+    CompiledDictionary compiledDictionary;
+};
+
+std::shared_ptr<SpellChecker> SpellCheckerFactory::CreateFromCompiledDictionary(
+    const std::string& path, std::error_code& errorCode)
+{
+    auto dictionary = OpenDictionary(path, errorCode);
+    if (errorCode) {
+        return nullptr;
+    }
+    return CreateWithDictionary(dictionary);
+}
+
+std::shared_ptr<const SpellCheckerDictionary> SpellCheckerFactory::CreateDictionary(
+    const std::vector<std::string>& words, std::error_code& errorCode)
+{
+    std::vector<char> image;
+    errorCode = BuildCompiledDictionaryImage(words, image);
+    if (errorCode) {
+        return nullptr;
+    }
+    auto dictionary = std::make_shared<SpellCheckerDictionary>();
+    errorCode = dictionary->compiledDictionary.Assign(std::move(image));
+    if (errorCode) {
+        return nullptr;
+    }
+    return dictionary;
+}
+
+std::shared_ptr<const SpellCheckerDictionary> SpellCheckerFactory::OpenDictionary(
+    const std::string& path, std::error_code& errorCode)
+{
+    auto dictionary = std::make_shared<SpellCheckerDictionary>();
+    errorCode = dictionary->compiledDictionary.Open(path);
+    if (errorCode) {
+        return nullptr;
+    }
+    return dictionary;
+}
+
+std::shared_ptr<SpellChecker> SpellCheckerFactory::CreateWithDictionary(
+    const std::shared_ptr<const SpellCheckerDictionary>& dictionary)
+{
+    assert(dictionary);
+
+    // NOTE: The spell checker keeps the whole base alive through the member.
+    std::shared_ptr<const CompiledDictionary> compiledDictionary(
+        dictionary, &dictionary->compiledDictionary);
+    return std::make_shared<SpellCheckerSignatureHashing>(std::move(compiledDictionary));
+}
+
+std::error_code CompileDictionary(
+    const std::vector<std::string>& words, const std::string& path)
+{
+    std::vector<char> image;
+    if (auto errorCode = BuildCompiledDictionaryImage(words, image)) {
+        return errorCode;
+    }
+
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    if (!output) {
+        return std::make_error_code(std::errc::permission_denied);
+    }
+    output.write(image.data(), image.size());
+    if (!output) {
+        return std::make_error_code(std::errc::io_error);
+    }
+    return {};
+}
+
+bool IsCompiledDictionary(const std::string& path)
+{
+    std::ifstream input(path, std::ios::binary);
+    char magic[sizeof(CompiledDictionaryMagic)];
+    if (!input.read(magic, sizeof(magic))) {
+        return false;
+    }
+    return std::memcmp(magic, CompiledDictionaryMagic, sizeof(magic)) == 0;
+}
+
 } // namespace somera
@@ -2,33 +2,134 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <system_error>
 #include <vector>
 
 namespace somera {
 
 struct SpellCheckResult {
+    ///@brief The corrections, best first. For a correctly spelled word,
+    /// this is only the dictionary word it matched, without near matches.
     std::vector<std::string> suggestions;
 
     ///@brief `true` if the word is correctly spelled; `false` otherwise.
     bool correctlySpelled;
 };
 
+///@brief Counters and cumulative timings of the stages of `Suggest`.
+struct SpellCheckerStats {
+    uint64_t queryCount = 0;
+
+    ///@brief Words found by the exact lookup without a fuzzy search.
+    uint64_t exactHitCount = 0;
+
+    ///@brief Signature buckets looked up, and how many of them exist.
+    uint64_t bucketLookupCount = 0;
+    uint64_t bucketHitCount = 0;
+
+    ///@brief Words in the buckets found, and how many of them pass the
+    /// length and character filters and get scored.
+    uint64_t candidateCount = 0;
+    uint64_t scoredCandidateCount = 0;
+
+    double probeSeconds = 0;
+    double identifierSeconds = 0;
+    double separationSeconds = 0;
+    double rankingSeconds = 0;
+};
+
+SpellCheckerStats& operator+=(SpellCheckerStats& stats, const SpellCheckerStats& other);
+
+///@brief Suggests corrections for misspelled words.
+///
+/// `Suggest` and `SuggestWords` may be called from any number of threads,
+/// also while another thread adds or removes words. Each call reads an
+/// immutable snapshot of the dictionary and never waits for an update. An
+/// update publishes a new snapshot before it returns, so the calls that
+/// start after it see its words.
 class SpellChecker {
 public:
     virtual ~SpellChecker() = default;
 
     virtual SpellCheckResult Suggest(const std::string& word) = 0;
 
+    ///@brief Suggests corrections for many words at once. Each distinct word
+    /// is checked only once, and the work is split across `threadCount`
+    /// threads. The results are in the same order as `words`.
+    virtual std::vector<SpellCheckResult> SuggestWords(
+        const std::vector<std::string>& words, int threadCount);
+
     virtual void AddWord(const std::string& word) = 0;
 
+    ///@brief Adds many words at once. This is much faster than calling
+    /// `AddWord` for each word when loading a large dictionary.
+    virtual void AddWords(const std::vector<std::string>& words);
+
     virtual void RemoveWord(const std::string& word) = 0;
+
+    ///@brief Adds and then removes words as a single update. Each update
+    /// copies the dictionary once, so batching words here or in `AddWords`
+    /// is cheaper than calling `AddWord` for each of them.
+    virtual void UpdateWords(
+        const std::vector<std::string>& addedWords,
+        const std::vector<std::string>& removedWords);
+
+    ///@brief Starts collecting `SpellCheckerStats`. Engines without the
+    /// instrumentation ignore this.
+    virtual void SetStatsEnabled(bool enabled);
+
+    virtual SpellCheckerStats GetStats() const;
+};
+
+///@brief An immutable dictionary that spell checkers share as their base
+/// layer. The words added to or removed from each spell checker only go into
+/// its own small layer on top of the base, which is resolved at lookup time.
+class SpellCheckerDictionary;
+
+enum class SpellCheckerEngine {
+    ///@brief Probes the buckets of the letter-histogram signature.
+    SignatureHashing,
+
+    ///@brief Looks up precomputed deletion variants (SymSpell).
+    SymmetricDelete,
+
+    ///@brief Walks a Levenshtein automaton over a minimal word graph (DAWG).
+    Dawg,
 };
 
 class SpellCheckerFactory final {
 public:
     static std::shared_ptr<SpellChecker> Create();
+
+    static std::shared_ptr<SpellChecker> Create(SpellCheckerEngine engine);
+
+    ///@brief Creates a signature hashing spell checker that maps the
+    /// compiled dictionary at `path` and queries it in place.
+    static std::shared_ptr<SpellChecker> CreateFromCompiledDictionary(
+        const std::string& path, std::error_code& errorCode);
+
+    ///@brief Compiles `words` in memory into a base dictionary.
+    static std::shared_ptr<const SpellCheckerDictionary> CreateDictionary(
+        const std::vector<std::string>& words, std::error_code& errorCode);
+
+    ///@brief Maps the compiled dictionary at `path` as a base dictionary.
+    static std::shared_ptr<const SpellCheckerDictionary> OpenDictionary(
+        const std::string& path, std::error_code& errorCode);
+
+    ///@brief Creates a signature hashing spell checker on top of `dictionary`.
+    /// Any number of spell checkers, on any threads, can share the same base.
+    static std::shared_ptr<SpellChecker> CreateWithDictionary(
+        const std::shared_ptr<const SpellCheckerDictionary>& dictionary);
 };
 
+///@brief Writes `words` into a deduplicated, pre-bucketed dictionary image.
+std::error_code CompileDictionary(
+    const std::vector<std::string>& words, const std::string& path);
+
+///@brief Returns `true` if the file at `path` is a compiled dictionary image.
+bool IsCompiledDictionary(const std::string& path);
+
 } // namespace somera
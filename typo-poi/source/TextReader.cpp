@@ -0,0 +1,250 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#include "TextReader.h"
+#include "MemoryMappedFile.h"
+#include "SourceLexer.h"
+#include "thirdparty/ConvertUTF.h"
+#include <cassert>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+
+namespace somera {
+namespace {
+
+///@brief Returns the end of the longest valid UTF-8 prefix of [first, last).
+const char* FindInvalidUTF8(const char* first, const char* last)
+{
+    constexpr uint64_t highBits = 0x8080808080808080ULL;
+
+    auto p = first;
+    while (p != last) {
+        // NOTE: Skips ASCII eight bytes at a time.
+        if (last - p >= 8) {
+            uint64_t block;
+            std::memcpy(&block, p, sizeof(block));
+            if ((block & highBits) == 0) {
+                p += 8;
+                continue;
+            }
+        }
+        auto source = reinterpret_cast<const UTF8*>(p);
+        if (*source < 0x80) {
+            ++p;
+            continue;
+        }
+        if (!isLegalUTF8Sequence(source, reinterpret_cast<const UTF8*>(last))) {
+            return p;
+        }
+        p += getNumBytesForUTF8(*source);
+    }
+    return last;
+}
+
+bool IsSpace(const char* p, std::size_t length)
+{
+    if (length == 1) {
+        return ::isspace(static_cast<unsigned char>(*p)) != 0;
+    }
+    // NOTE: U+3000 IDEOGRAPHIC SPACE
+    return (length == 3) && (std::memcmp(p, "\xE3\x80\x80", 3) == 0);
+}
+
+///@brief Calls `callback` for each word in [first, last), which starts at `position`.
+std::error_code ReadWords(
+    const char* first,
+    const char* last,
+    TextPosition position,
+    const std::function<void(const WordView&)>& callback,
+    TextPosition& errorPosition)
+{
+    const auto validLast = FindInvalidUTF8(first, last);
+
+    TextPosition wordPosition;
+    const char* wordFirst = nullptr;
+
+    auto p = first;
+    while (p != validLast) {
+        const auto length = getNumBytesForUTF8(static_cast<UTF8>(*p));
+        assert(p + length <= validLast);
+
+        if (IsSpace(p, length)) {
+            if (wordFirst != nullptr) {
+                callback(WordView{StringView(wordFirst, p - wordFirst), wordPosition});
+                wordFirst = nullptr;
+            }
+        }
+        else if (wordFirst == nullptr) {
+            wordFirst = p;
+            wordPosition = position;
+        }
+
+        if (*p == '\n') {
+            position.line++;
+            position.column = 0;
+        }
+        else {
+            position.column++;
+        }
+        p += length;
+    }
+
+    if (validLast != last) {
+        errorPosition = position;
+        return std::make_error_code(std::errc::illegal_byte_sequence);
+    }
+    if (wordFirst != nullptr) {
+        callback(WordView{StringView(wordFirst, p - wordFirst), wordPosition});
+    }
+    return {};
+}
+
+///@brief Returns the position of `p` in the text that starts at `first`.
+TextPosition GetTextPosition(const char* first, const char* p)
+{
+    TextPosition position;
+    auto lineFirst = first;
+    for (;;) {
+        auto lineEnd = static_cast<const char*>(std::memchr(lineFirst, '\n', p - lineFirst));
+        if (lineEnd == nullptr) {
+            break;
+        }
+        position.line++;
+        lineFirst = lineEnd + 1;
+    }
+    for (; lineFirst != p; ++lineFirst) {
+        if ((static_cast<uint8_t>(*lineFirst) & 0xC0) != 0x80) {
+            position.column++;
+        }
+    }
+    return position;
+}
+
+///@brief Calls `callback` for each word of the comments, string literals
+/// and identifiers of the source file that `isLineRead(line)` accepts.
+std::error_code ReadSourceWords(
+    const std::string& path,
+    const std::function<bool(std::size_t line)>& isLineRead,
+    const std::function<void(const WordView&)>& callback,
+    TextPosition& errorPosition)
+{
+    assert(callback);
+
+    MemoryMappedFile file;
+    if (auto errorCode = file.Open(path)) {
+        return errorCode;
+    }
+
+    // NOTE: Lexes up to the first invalid byte, like `ReadWords`.
+    const auto first = file.GetData();
+    const auto last = first + file.GetSize();
+    const auto validLast = FindInvalidUTF8(first, last);
+
+    auto onWord = [&](const WordView& word) {
+        if (isLineRead(word.position.line)) {
+            callback(word);
+        }
+    };
+    LexSource(StringView(first, validLast - first), [&](const SourceToken& token) {
+        if (token.kind == SourceTokenKind::Identifier) {
+            onWord(WordView{token.text, token.position});
+            return;
+        }
+        const auto tokenFirst = token.text.data();
+        TextPosition unused;
+        ReadWords(tokenFirst, tokenFirst + token.text.size(), token.position, onWord, unused);
+    });
+
+    if (validLast != last) {
+        errorPosition = GetTextPosition(first, validLast);
+        return std::make_error_code(std::errc::illegal_byte_sequence);
+    }
+    return {};
+}
+
+} // unnamed namespace
+
+std::error_code ReadWordsFromTextFile(
+    const std::string& path,
+    const std::function<void(const WordView&)>& callback,
+    TextPosition& errorPosition)
+{
+    assert(callback);
+
+    MemoryMappedFile file;
+    if (auto errorCode = file.Open(path)) {
+        return errorCode;
+    }
+
+    const auto first = file.GetData();
+    return ReadWords(first, first + file.GetSize(), TextPosition{}, callback, errorPosition);
+}
+
+std::error_code ReadWordsFromTextLines(
+    const std::string& path,
+    const std::vector<LineRange>& lineRanges,
+    const std::function<void(const WordView&)>& callback,
+    TextPosition& errorPosition)
+{
+    assert(callback);
+
+    MemoryMappedFile file;
+    if (auto errorCode = file.Open(path)) {
+        return errorCode;
+    }
+
+    const auto last = file.GetData() + file.GetSize();
+
+    // NOTE: Skips a line at a time without decoding.
+    auto skipLines = [&](const char* p, std::size_t count) {
+        for (; (count > 0) && (p != last); --count) {
+            auto lineEnd = static_cast<const char*>(std::memchr(p, '\n', last - p));
+            p = (lineEnd != nullptr) ? (lineEnd + 1) : last;
+        }
+        return p;
+    };
+
+    auto p = file.GetData();
+    std::size_t line = 1;
+    for (auto & range : lineRanges) {
+        assert(range.first >= line);
+        p = skipLines(p, range.first - line);
+        const auto rangeLast = skipLines(p, range.count);
+
+        TextPosition position;
+        position.line = range.first;
+        if (auto errorCode = ReadWords(p, rangeLast, position, callback, errorPosition)) {
+            return errorCode;
+        }
+        p = rangeLast;
+        line = range.first + range.count;
+    }
+    return {};
+}
+
+std::error_code ReadWordsFromSourceFile(
+    const std::string& path,
+    const std::function<void(const WordView&)>& callback,
+    TextPosition& errorPosition)
+{
+    return ReadSourceWords(path, [](std::size_t) { return true; }, callback, errorPosition);
+}
+
+std::error_code ReadWordsFromSourceLines(
+    const std::string& path,
+    const std::vector<LineRange>& lineRanges,
+    const std::function<void(const WordView&)>& callback,
+    TextPosition& errorPosition)
+{
+    // NOTE: The words are reported in order, so the ranges are walked once.
+    auto range = std::begin(lineRanges);
+    auto isLineRead = [&](std::size_t line) {
+        while ((range != std::end(lineRanges)) && (range->first + range->count <= line)) {
+            ++range;
+        }
+        return (range != std::end(lineRanges)) && (range->first <= line);
+    };
+    return ReadSourceWords(path, isLineRead, callback, errorPosition);
+}
+
+} // namespace somera
@@ -0,0 +1,75 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#pragma once
+
+#include "somera/StringView.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace somera {
+
+struct TextPosition {
+    ///@brief 1-based line number.
+    std::size_t line = 1;
+
+    ///@brief 0-based column, counted in UTF-8 characters.
+    std::size_t column = 0;
+};
+
+///@brief Consecutive lines of a file.
+struct LineRange {
+    ///@brief 1-based number of the first line.
+    std::size_t first = 1;
+
+    std::size_t count = 0;
+};
+
+///@brief A whitespace-separated word that points into the mapped file.
+struct WordView {
+    StringView text;
+    TextPosition position;
+};
+
+///@brief Maps the file and calls `callback` for each whitespace-separated
+/// word without copying the text.
+///
+/// On invalid UTF-8, the words before the bad byte are still reported, and
+/// `errorPosition` receives the location of that byte.
+std::error_code ReadWordsFromTextFile(
+    const std::string& path,
+    const std::function<void(const WordView&)>& callback,
+    TextPosition& errorPosition);
+
+///@brief Same as `ReadWordsFromTextFile`, but reads only the words on the
+/// lines in `lineRanges`, which must be sorted and must not overlap.
+///
+/// Only those lines are checked for invalid UTF-8.
+std::error_code ReadWordsFromTextLines(
+    const std::string& path,
+    const std::vector<LineRange>& lineRanges,
+    const std::function<void(const WordView&)>& callback,
+    TextPosition& errorPosition);
+
+///@brief Same as `ReadWordsFromTextFile`, but lexes the file as C/C++
+/// source code and reads only the words of its comments and string
+/// literals, and its identifiers.
+std::error_code ReadWordsFromSourceFile(
+    const std::string& path,
+    const std::function<void(const WordView&)>& callback,
+    TextPosition& errorPosition);
+
+///@brief Same as `ReadWordsFromSourceFile`, but reads only the words on the
+/// lines in `lineRanges`, which must be sorted and must not overlap.
+///
+/// The file is still lexed from the start to find the comments that begin
+/// before the lines, so the whole file is checked for invalid UTF-8.
+std::error_code ReadWordsFromSourceLines(
+    const std::string& path,
+    const std::vector<LineRange>& lineRanges,
+    const std::function<void(const WordView&)>& callback,
+    TextPosition& errorPosition);
+
+} // namespace somera
@@ -0,0 +1,43 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#include "TokenTable.h"
+#include <cassert>
+#include <limits>
+
+namespace somera {
+
+std::size_t TokenTable::Hash::operator()(const StringView& text) const noexcept
+{
+    // NOTE: 64-bit FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (auto c : text) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+TokenId TokenTable::Intern(const StringView& text)
+{
+    auto iter = tokens.find(text);
+    if (iter != std::end(tokens)) {
+        return iter->second;
+    }
+    assert(texts.size() < std::numeric_limits<TokenId>::max());
+    const auto token = static_cast<TokenId>(texts.size());
+    texts.push_back(text.toString());
+    tokens.emplace(StringView(texts.back()), token);
+    return token;
+}
+
+std::vector<TokenId> TokenTable::Merge(const TokenTable& other)
+{
+    std::vector<TokenId> newTokens;
+    newTokens.reserve(other.GetSize());
+    for (auto & text : other.texts) {
+        newTokens.push_back(Intern(text));
+    }
+    return newTokens;
+}
+
+} // namespace somera
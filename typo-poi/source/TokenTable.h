@@ -0,0 +1,67 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#pragma once
+
+#include "somera/StringView.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace somera {
+
+using TokenId = uint32_t;
+
+///@brief An occurrence of a token in a file.
+struct TokenOccurrence {
+    TokenId token;
+
+    ///@brief 1-based line number.
+    uint32_t line;
+};
+
+///@brief Interns the words of the scanned files to dense ids, so that each
+/// unique word is spell checked once however often it occurs.
+class TokenTable final {
+public:
+    TokenTable() = default;
+
+    TokenTable(const TokenTable&) = delete;
+
+    TokenTable& operator=(const TokenTable&) = delete;
+
+    TokenTable(TokenTable&&) = default;
+
+    TokenTable& operator=(TokenTable&&) = default;
+
+    ///@brief Returns the id of the text, adding it if it is new.
+    /// The ids are assigned from 0 in the order the texts are added.
+    TokenId Intern(const StringView& text);
+
+    ///@brief Interns the tokens of `other`, and returns the new ids indexed
+    /// by the ids in `other`.
+    std::vector<TokenId> Merge(const TokenTable& other);
+
+    const std::string& GetText(TokenId token) const
+    {
+        return texts[token];
+    }
+
+    std::size_t GetSize() const noexcept
+    {
+        return texts.size();
+    }
+
+private:
+    struct Hash {
+        std::size_t operator()(const StringView& text) const noexcept;
+    };
+
+    ///@brief The keys point into `texts`, whose elements never move.
+    std::unordered_map<StringView, TokenId, Hash> tokens;
+    std::deque<std::string> texts;
+};
+
+} // namespace somera
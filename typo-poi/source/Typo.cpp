@@ -7,6 +7,7 @@
 #include "somera/StringHelper.h"
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <iterator>
 #include <utility>
 
@@ -21,157 +22,330 @@ void eraseIf(Container & container, Func func)
         std::end(container));
 }
 
+///@brief Adds the time until destruction to `*seconds`, unless `seconds`
+/// is `nullptr`.
+class ScopedTimer final {
+public:
+    explicit ScopedTimer(double* secondsIn)
+        : seconds(secondsIn)
+    {
+        if (seconds != nullptr) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer()
+    {
+        if (seconds != nullptr) {
+            const auto duration = std::chrono::steady_clock::now() - start;
+            *seconds += std::chrono::duration<double>(duration).count();
+        }
+    }
+
+private:
+    double* seconds;
+    std::chrono::steady_clock::time_point start;
+};
+
 } // unnamed namespace
 
+TypoManStats& operator+=(TypoManStats& stats, const TypoManStats& other)
+{
+    stats.sentenceCount += other.sentenceCount;
+    stats.wordCount += other.wordCount;
+    stats.shortWordCount += other.shortWordCount;
+    stats.cacheHitCount += other.cacheHitCount;
+    stats.suggestCount += other.suggestCount;
+    stats.typoCount += other.typoCount;
+    stats.segmentationSeconds += other.segmentationSeconds;
+    stats.cacheSeconds += other.cacheSeconds;
+    stats.suggestSeconds += other.suggestSeconds;
+    stats.diffFilterSeconds += other.diffFilterSeconds;
+    return stats;
+}
+
 TypoCache::TypoCache()
     : maxCacheSize(20)
+    , hitCount(0)
+    , missCount(0)
+    , evictedCount(0)
 {
     setCapacity(maxCacheSize);
 }
 
-bool TypoCache::exists(const std::string& misspelledWord) const
+bool TypoCache::exists(const std::string& misspelledWord)
 {
-    auto iter = std::find_if(std::rbegin(typos), std::rend(typos), [&](const TypoCacheInfo& info) {
-        return info.misspelledWord == misspelledWord;
-    });
-    return (iter != std::rend(typos));
+    auto iter = typos.find(misspelledWord);
+    if (iter == std::end(typos)) {
+        ++missCount;
+        return false;
+    }
+    ++hitCount;
+    touch(iter->second);
+    return true;
 }
 
 void TypoCache::setCapacity(size_t capacity)
 {
     assert(capacity > 1);
     maxCacheSize = std::max<size_t>(10, capacity);
-    if (typos.size() > maxCacheSize) {
-        typos.resize(maxCacheSize);
-        typos.shrink_to_fit();
-    }
-    if (typos.capacity() < maxCacheSize) {
-        typos.reserve(maxCacheSize);
+    while (typos.size() > maxCacheSize) {
+        evict();
     }
+    typos.reserve(maxCacheSize);
     assert(typos.size() <= maxCacheSize);
-    assert(typos.capacity() <= maxCacheSize);
 }
 
 void TypoCache::insert(Typo && typo)
 {
-    assert(typos.size() <= typos.capacity());
+    auto iter = typos.find(typo.misspelledWord);
+    if (iter != std::end(typos)) {
+        touch(iter->second);
+        return;
+    }
 
-    auto iter = std::find_if(std::rbegin(typos), std::rend(typos), [&](const TypoCacheInfo& info) {
-        return info.misspelledWord == typo.misspelledWord;
-    });
+    if (typos.size() >= maxCacheSize) {
+        assert(maxCacheSize > 0);
+        assert(!typos.empty());
+        evict();
+    }
 
-    if (iter == std::rend(typos)) {
-        if (typos.size() > 10) {
-            std::sort(std::rbegin(typos), std::next(std::rbegin(typos), typos.size() / 3),
-                [](const TypoCacheInfo& a, const TypoCacheInfo& b) {
-                    return a.count > b.count;
-                });
-        }
-        if (typos.size() >= maxCacheSize) {
-            assert(maxCacheSize > 0);
-            assert(!typos.empty());
-            typos.erase(std::begin(typos));
-        }
-        assert(typos.size() <= typos.capacity());
-        TypoCacheInfo cacheInfo;
-        cacheInfo.misspelledWord = std::move(typo.misspelledWord);
-        cacheInfo.count = 1;
-        typos.push_back(std::move(cacheInfo));
+    // NOTE:
+    // LFU with dynamic aging: a new word starts just above the count of the
+    // word evicted last, instead of at one. It outranks the words that have
+    // not been hit since that eviction, so the next new word evicts one of
+    // them rather than this one. Every count is at least `evictedCount`,
+    // so the node is found within the first two.
+    const auto count = evictedCount + 1;
+    auto frequency = std::begin(frequencies);
+    while ((frequency != std::end(frequencies)) && (frequency->count < count)) {
+        ++frequency;
+    }
+    if ((frequency == std::end(frequencies)) || (frequency->count != count)) {
+        FrequencyNode node;
+        node.count = count;
+        frequency = frequencies.insert(frequency, std::move(node));
+    }
+    frequency->words.push_back(std::move(typo.misspelledWord));
+
+    TypoCacheInfo cacheInfo;
+    cacheInfo.frequency = frequency;
+    cacheInfo.word = std::prev(std::end(frequency->words));
+    typos.emplace(frequency->words.back(), cacheInfo);
+    assert(typos.size() <= maxCacheSize);
+}
+
+std::size_t TypoCache::getHitCount() const noexcept
+{
+    return hitCount;
+}
+
+std::size_t TypoCache::getMissCount() const noexcept
+{
+    return missCount;
+}
+
+void TypoCache::touch(TypoCacheInfo & info)
+{
+    // NOTE: Moves the word to the node for the next count, creating it if needed.
+    auto current = info.frequency;
+    auto next = std::next(current);
+    if ((next == std::end(frequencies)) || (next->count != current->count + 1)) {
+        FrequencyNode node;
+        node.count = current->count + 1;
+        next = frequencies.insert(next, std::move(node));
+    }
+    next->words.splice(std::end(next->words), current->words, info.word);
+    info.frequency = next;
+    if (current->words.empty()) {
+        frequencies.erase(current);
     }
-    else {
-        TypoCacheInfo cacheInfo;
-        std::swap(*iter, cacheInfo);
-        cacheInfo.count++;
-        typos.erase(std::next(iter).base());
+}
+
+void TypoCache::evict()
+{
+    assert(!frequencies.empty());
+    auto frequency = std::begin(frequencies);
+    assert(!frequency->words.empty());
+
+    // NOTE: Evicts the least recently used word among the least frequent ones.
+    evictedCount = frequency->count;
+    typos.erase(frequency->words.front());
+    frequency->words.pop_front();
+    if (frequency->words.empty()) {
+        frequencies.erase(frequency);
     }
 }
 
 TypoMan::TypoMan() noexcept
-    : minimumWordSize(3)
+    : TypoMan(SpellCheckerFactory::Create())
+{
+}
+
+TypoMan::TypoMan(const std::shared_ptr<SpellChecker>& spellCheckerIn) noexcept
+    : spellChecker(spellCheckerIn)
+    , minimumWordSize(3)
     , maxCorrectWordCount(4)
     , isStrictWhiteSpace(true)
     , isStrictHyphen(true)
     , isStrictLetterCase(true)
+    , isStatsEnabled(false)
 {
-    spellChecker = SpellCheckerFactory::Create();
+    assert(spellChecker);
 }
 
 void TypoMan::computeFromSentence(
-    const std::string& sentence, const TypoSource& sourceIn)
+    StringView sentence, const TypoSource& sourceIn)
 {
-    segmenter.parse(sentence, [&](const somera::PartOfSpeech& pos)
+    // NOTE: The segmentation time is the rest of the time spent in `Parse`.
+    const auto wordStats = stats;
+    double parseSeconds = 0;
     {
-        const auto word = pos.text;
-        if (pos.tag != somera::PartOfSpeechTag::Raw &&
-            pos.tag != somera::PartOfSpeechTag::EnglishWord) {
-            return;
-        }
-        if (isCacheEnabled && cache.exists(word)) {
-            return;
-        }
-        computeFromWord(word);
-    });
+        ScopedTimer timer(isStatsEnabled ? &parseSeconds : nullptr);
+        segmenter.Parse(sentence, [&](const somera::PartOfSpeech& pos)
+        {
+            if (pos.tag != somera::PartOfSpeechTag::Word) {
+                return;
+            }
+            if (isStatsEnabled) {
+                ++stats.wordCount;
+            }
+            computeFromWord(pos.text.toString(), sourceIn);
+        });
+    }
+    if (isStatsEnabled) {
+        ++stats.sentenceCount;
+        stats.segmentationSeconds += parseSeconds
+            - (stats.cacheSeconds - wordStats.cacheSeconds)
+            - (stats.suggestSeconds - wordStats.suggestSeconds)
+            - (stats.diffFilterSeconds - wordStats.diffFilterSeconds);
+    }
+}
+
+void TypoMan::collectWords(
+    StringView sentence, const std::function<void(StringView)>& callback)
+{
+    assert(callback);
+    {
+        ScopedTimer timer(isStatsEnabled ? &stats.segmentationSeconds : nullptr);
+        segmenter.Parse(sentence, [&](const somera::PartOfSpeech& pos)
+        {
+            if (pos.tag != somera::PartOfSpeechTag::Word) {
+                return;
+            }
+            if (isStatsEnabled) {
+                ++stats.wordCount;
+            }
+            if (pos.text.empty()) {
+                return;
+            }
+            if (static_cast<int>(pos.text.size()) < minimumWordSize) {
+                if (isStatsEnabled) {
+                    ++stats.shortWordCount;
+                }
+                return;
+            }
+            callback(pos.text);
+        });
+    }
+    if (isStatsEnabled) {
+        ++stats.sentenceCount;
+    }
 }
 
 void TypoMan::computeFromWord(const std::string& word)
+{
+    computeFromWord(word, TypoSource{});
+}
+
+void TypoMan::computeFromWord(const std::string& word, const TypoSource& source)
 {
     if (word.empty()) {
         return;
     }
     if (static_cast<int>(word.size()) < minimumWordSize) {
+        if (isStatsEnabled) {
+            ++stats.shortWordCount;
+        }
         return;
     }
-    if (isCacheEnabled && cache.exists(word)) {
-        return;
+    if (isCacheEnabled) {
+        ScopedTimer timer(isStatsEnabled ? &stats.cacheSeconds : nullptr);
+        if (cache.exists(word)) {
+            if (isStatsEnabled) {
+                ++stats.cacheHitCount;
+            }
+            return;
+        }
+    }
+
+    SpellCheckResult suggestResult;
+    {
+        ScopedTimer timer(isStatsEnabled ? &stats.suggestSeconds : nullptr);
+        suggestResult = spellChecker->Suggest(word);
     }
+    computeFromSuggestions(word, std::move(suggestResult), source);
+}
 
-    auto suggestResult = spellChecker->Suggest(word);
+void TypoMan::computeFromSuggestions(
+    const std::string& word, SpellCheckResult && suggestResult, const TypoSource& source)
+{
+    if (isStatsEnabled) {
+        ++stats.suggestCount;
+    }
     if (suggestResult.suggestions.empty()) {
         return;
     }
-    if (!isStrictWhiteSpace) {
-        for (auto & correction : suggestResult.suggestions) {
-            auto hunks = somera::computeDiff(word, correction);
-            std::string filtered;
-            for (auto & hunk : hunks) {
-                if (hunk.operation != DiffOperation::Equality
-                    && hunk.text == " ") {
-                    continue;
+
+    {
+        ScopedTimer timer(isStatsEnabled ? &stats.diffFilterSeconds : nullptr);
+        if (!isStrictWhiteSpace) {
+            for (auto & correction : suggestResult.suggestions) {
+                auto hunks = somera::computeDiff(word, correction);
+                std::string filtered;
+                for (auto & hunk : hunks) {
+                    if (hunk.operation != DiffOperation::Equality
+                        && hunk.text == " ") {
+                        continue;
+                    }
+                    if (hunk.operation != DiffOperation::Deletion) {
+                        filtered += hunk.text;
+                    }
                 }
-                if (hunk.operation != DiffOperation::Deletion) {
-                    filtered += hunk.text;
+                if (filtered == word) {
+                    return;
                 }
+                correction = filtered;
             }
-            if (filtered == word) {
-                return;
-            }
-            correction = filtered;
+            eraseIf(suggestResult.suggestions, [&](const std::string& correction) {
+                return correction.empty();
+            });
         }
-        eraseIf(suggestResult.suggestions, [&](const std::string& correction) {
-            return correction.empty();
-        });
-    }
-    if (!isStrictHyphen) {
-        for (auto & correction : suggestResult.suggestions) {
-            auto hunks = somera::computeDiff(word, correction);
-            std::string filtered;
-            for (auto & hunk : hunks) {
-                if (hunk.operation != DiffOperation::Equality
-                    && hunk.text == "-") {
-                    continue;
+        if (!isStrictHyphen) {
+            for (auto & correction : suggestResult.suggestions) {
+                auto hunks = somera::computeDiff(word, correction);
+                std::string filtered;
+                for (auto & hunk : hunks) {
+                    if (hunk.operation != DiffOperation::Equality
+                        && hunk.text == "-") {
+                        continue;
+                    }
+                    if (hunk.operation != DiffOperation::Deletion) {
+                        filtered += hunk.text;
+                    }
                 }
-                if (hunk.operation != DiffOperation::Deletion) {
-                    filtered += hunk.text;
+                if (filtered == word) {
+                    return;
                 }
+                correction = filtered;
             }
-            if (filtered == word) {
-                return;
-            }
-            correction = filtered;
+            eraseIf(suggestResult.suggestions, [&](const std::string& correction) {
+                return correction.empty();
+            });
         }
-        eraseIf(suggestResult.suggestions, [&](const std::string& correction) {
-            return correction.empty();
-        });
     }
 
     assert(maxCorrectWordCount > 0);
@@ -180,16 +354,38 @@ void TypoMan::computeFromWord(const std::string& word)
     }
 
     Typo typo;
+    typo.location = source.location;
     typo.misspelledWord = word;
     typo.corrections = std::move(suggestResult.suggestions);
+    if (isStatsEnabled && !typo.corrections.empty()) {
+        ++stats.typoCount;
+    }
     if (onFoundTypo && !typo.corrections.empty()) {
         onFoundTypo(typo);
     }
     if (isCacheEnabled) {
+        ScopedTimer timer(isStatsEnabled ? &stats.cacheSeconds : nullptr);
         cache.insert(std::move(typo));
     }
 }
 
+void TypoMan::replayTypo(const Typo& typo)
+{
+    if (isCacheEnabled && cache.exists(typo.misspelledWord)) {
+        if (isStatsEnabled) {
+            ++stats.cacheHitCount;
+        }
+        return;
+    }
+    if (onFoundTypo && !typo.corrections.empty()) {
+        onFoundTypo(typo);
+    }
+    if (isCacheEnabled) {
+        auto copy = typo;
+        cache.insert(std::move(copy));
+    }
+}
+
 void TypoMan::setSpellChecker(const std::shared_ptr<SpellChecker>& spellCheckerIn)
 {
     this->spellChecker = spellCheckerIn;
@@ -228,10 +424,25 @@ void TypoMan::setCacheSize(std::size_t cacheSize)
     this->cache.setCapacity(cacheSize);
 }
 
+const TypoCache& TypoMan::getCache() const noexcept
+{
+    return cache;
+}
+
 void TypoMan::setFoundCallback(std::function<void(const Typo&)> callback)
 {
     assert(callback);
     onFoundTypo = callback;
 }
 
+void TypoMan::setStatsEnabled(bool statsEnabled)
+{
+    this->isStatsEnabled = statsEnabled;
+}
+
+const TypoManStats& TypoMan::getStats() const noexcept
+{
+    return stats;
+}
+
 } // namespace somera
@@ -4,16 +4,22 @@
 
 #include "wordsegmenter.h"
 #include "somera/Optional.h"
+#include "somera/StringView.h"
 #include "SpellChecker.h"
 #include <functional>
+#include <list>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace somera {
 
 struct SourceLocation {
     std::string filePath;
+
+    ///@brief 1-based line number, or 0 if unknown.
+    std::size_t line = 0;
 };
 
 struct Typo {
@@ -28,47 +34,123 @@ struct TypoSource {
     //SourceRange range;
 };
 
+///@brief A least-frequently-used cache of misspelled words.
+/// Lookups, insertions and evictions are all O(1).
 class TypoCache final {
 public:
     TypoCache();
 
-    bool exists(const std::string& typo) const;
+    ///@brief Returns `true` and bumps the frequency of the word on a cache hit.
+    bool exists(const std::string& typo);
 
     void setCapacity(size_t capacity);
 
     void insert(Typo && typo);
 
+    std::size_t getHitCount() const noexcept;
+
+    std::size_t getMissCount() const noexcept;
+
 private:
+    struct FrequencyNode;
+    using FrequencyIterator = std::list<FrequencyNode>::iterator;
+
+    struct FrequencyNode {
+        ///@brief Words with the same count, from the least recently used.
+        std::list<std::string> words;
+        std::size_t count;
+    };
+
     struct TypoCacheInfo {
-        std::string misspelledWord;
-        int count;
+        FrequencyIterator frequency;
+        std::list<std::string>::iterator word;
     };
 
-    std::vector<TypoCacheInfo> typos;
+    void touch(TypoCacheInfo & info);
+
+    void evict();
+
+    ///@brief Frequency nodes sorted by count in ascending order.
+    std::list<FrequencyNode> frequencies;
+    std::unordered_map<std::string, TypoCacheInfo> typos;
     std::size_t maxCacheSize;
+    std::size_t hitCount;
+    std::size_t missCount;
+
+    ///@brief The count of the word evicted last, which new words start above.
+    std::size_t evictedCount;
+};
+
+///@brief Counters and cumulative timings of the stages in `TypoMan`.
+struct TypoManStats {
+    std::size_t sentenceCount = 0;
+    std::size_t wordCount = 0;
+
+    ///@brief Words skipped by `setMinimumWordSize`.
+    std::size_t shortWordCount = 0;
+
+    std::size_t cacheHitCount = 0;
+    std::size_t suggestCount = 0;
+    std::size_t typoCount = 0;
+
+    ///@brief Time in the segmenter, excluding the words it reports.
+    double segmentationSeconds = 0;
+    double cacheSeconds = 0;
+    double suggestSeconds = 0;
+
+    ///@brief Time spent dropping corrections that only differ in
+    /// whitespace or hyphens.
+    double diffFilterSeconds = 0;
 };
 
+TypoManStats& operator+=(TypoManStats& stats, const TypoManStats& other);
+
 class TypoMan final {
 private:
     std::shared_ptr<somera::SpellChecker> spellChecker;
     somera::WordSegmenter segmenter;
     TypoCache cache;
     std::function<void(const Typo&)> onFoundTypo;
+    TypoManStats stats;
     int minimumWordSize;
     int maxCorrectWordCount;
     bool isStrictWhiteSpace;
     bool isStrictHyphen;
     bool isStrictLetterCase;
     bool isCacheEnabled;
+    bool isStatsEnabled;
 
 public:
     TypoMan() noexcept;
 
+    ///@brief Checks the words with `spellChecker`, which may be shared with
+    /// other TypoMan instances.
+    explicit TypoMan(const std::shared_ptr<SpellChecker>& spellChecker) noexcept;
+
     void computeFromSentence(
-        const std::string& sentence, const TypoSource& source);
+        StringView sentence, const TypoSource& source);
+
+    ///@brief Calls `callback` for each word in the sentence that
+    /// `computeFromSentence` would check, without checking them.
+    void collectWords(
+        StringView sentence, const std::function<void(StringView)>& callback);
 
     void computeFromWord(const std::string& word);
 
+    ///@brief Reports the typo, if any, at the location of `source`.
+    void computeFromWord(const std::string& word, const TypoSource& source);
+
+    ///@brief Same as `computeFromWord`, but with the result of the spell
+    /// checker already computed, such as by `SpellChecker::SuggestWords`.
+    /// The word is not looked up in the cache.
+    void computeFromSuggestions(
+        const std::string& word, SpellCheckResult && suggestResult, const TypoSource& source);
+
+    ///@brief Reports a typo found earlier, such as by another TypoMan or in a
+    /// previous run, through the cache and the found callback as if it had
+    /// just been found.
+    void replayTypo(const Typo& typo);
+
     void setSpellChecker(const std::shared_ptr<SpellChecker>& spellChecker);
 
     void setMinimumWordSize(int wordSize);
@@ -83,7 +165,14 @@ public:
 
     void setCacheSize(std::size_t cacheSize);
 
+    const TypoCache& getCache() const noexcept;
+
     void setFoundCallback(std::function<void(const Typo&)> callback);
+
+    ///@brief Starts collecting `TypoManStats`.
+    void setStatsEnabled(bool statsEnabled);
+
+    const TypoManStats& getStats() const noexcept;
 };
 
 } // namespace somera
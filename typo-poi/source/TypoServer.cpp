@@ -0,0 +1,389 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#include "TypoServer.h"
+#include "somera/StringHelper.h"
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <utility>
+
+#if !defined(_MSC_VER)
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace somera {
+
+#if defined(_MSC_VER)
+
+// TODO: Unix domain sockets are not supported on Windows yet.
+TypoServer::TypoServer(const CheckFileFunction& checkFileIn)
+    : checkFile(checkFileIn)
+{
+}
+
+TypoServer::~TypoServer() = default;
+
+std::error_code TypoServer::Listen(const std::string&)
+{
+    return std::make_error_code(std::errc::operation_not_supported);
+}
+
+std::error_code TypoServer::Run()
+{
+    return std::make_error_code(std::errc::operation_not_supported);
+}
+
+void TypoServer::Serve(int)
+{
+}
+
+TypoClient::~TypoClient() = default;
+
+std::error_code TypoClient::Connect(const std::string&)
+{
+    return std::make_error_code(std::errc::operation_not_supported);
+}
+
+std::error_code TypoClient::CheckFile(const std::string&, std::vector<Typo>&, TextPosition&)
+{
+    return std::make_error_code(std::errc::operation_not_supported);
+}
+
+#else
+
+namespace {
+
+#if defined(MSG_NOSIGNAL)
+constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+constexpr int SendFlags = 0;
+#endif
+
+// NOTE:
+// A request is a verb and one path, so a longer line is not a request of
+// this protocol. Limiting it keeps a client from growing the buffer
+// without bound.
+#if defined(PATH_MAX)
+constexpr std::size_t MaxRequestSize = PATH_MAX + 64;
+#else
+constexpr std::size_t MaxRequestSize = 4096 + 64;
+#endif
+
+// NOTE: Each connection is served on its own thread, so the server stops
+// accepting while this many are open and leaves the rest in the backlog.
+constexpr int MaxConnectionCount = 64;
+
+std::error_code GetLastError()
+{
+    return std::error_code(errno, std::generic_category());
+}
+
+std::error_code OpenSocket(const std::string& socketPath, sockaddr_un& address, int& socketHandle)
+{
+    if (socketPath.empty() || (socketPath.size() >= sizeof(address.sun_path))) {
+        return std::make_error_code(std::errc::filename_too_long);
+    }
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    socketHandle = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socketHandle < 0) {
+        return GetLastError();
+    }
+#if defined(SO_NOSIGPIPE)
+    // NOTE: Reports a closed peer as EPIPE instead of raising SIGPIPE.
+    int enabled = 1;
+    ::setsockopt(socketHandle, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+#endif
+    return {};
+}
+
+std::error_code ConnectSocket(const std::string& socketPath, int& socketHandle)
+{
+    sockaddr_un address;
+    if (auto errorCode = OpenSocket(socketPath, address, socketHandle)) {
+        return errorCode;
+    }
+    if (::connect(socketHandle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        auto errorCode = GetLastError();
+        ::close(socketHandle);
+        socketHandle = -1;
+        return errorCode;
+    }
+    return {};
+}
+
+std::error_code WriteAll(int socketHandle, const std::string& data)
+{
+    std::size_t offset = 0;
+    while (offset < data.size()) {
+        const auto size = ::send(socketHandle, data.data() + offset, data.size() - offset, SendFlags);
+        if (size < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return GetLastError();
+        }
+        offset += static_cast<std::size_t>(size);
+    }
+    return {};
+}
+
+///@brief Reads a line without the line break. The bytes received after
+/// the line stay in `buffer` for the next call. Fails with `message_size`
+/// if the line is longer than `maxLineSize`.
+std::error_code ReadLine(
+    int socketHandle, std::size_t maxLineSize, std::string & buffer, std::string & line)
+{
+    for (;;) {
+        const auto lineEnd = buffer.find('\n');
+        if (lineEnd != std::string::npos) {
+            if (lineEnd > maxLineSize) {
+                return std::make_error_code(std::errc::message_size);
+            }
+            line.assign(buffer, 0, lineEnd);
+            buffer.erase(0, lineEnd + 1);
+            return {};
+        }
+        if (buffer.size() > maxLineSize) {
+            return std::make_error_code(std::errc::message_size);
+        }
+        char chunk[4096];
+        const auto size = ::recv(socketHandle, chunk, sizeof(chunk), 0);
+        if (size < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return GetLastError();
+        }
+        if (size == 0) {
+            return std::make_error_code(std::errc::connection_reset);
+        }
+        buffer.append(chunk, static_cast<std::size_t>(size));
+    }
+}
+
+void AppendField(std::string & line, const std::string& field)
+{
+    line += '\t';
+    for (auto c : field) {
+        line += ((c == '\t') || (c == '\n') || (c == '\r')) ? ' ' : c;
+    }
+}
+
+} // unnamed namespace
+
+TypoServer::TypoServer(const CheckFileFunction& checkFileIn)
+    : checkFile(checkFileIn)
+{
+    assert(checkFile);
+}
+
+TypoServer::~TypoServer()
+{
+    if (listener >= 0) {
+        ::close(listener);
+    }
+}
+
+std::error_code TypoServer::Listen(const std::string& socketPath)
+{
+    assert(listener < 0);
+
+    // NOTE: A socket file that nobody accepts on was left by a server that
+    // did not exit cleanly, so it is safe to replace.
+    int probe = -1;
+    if (!ConnectSocket(socketPath, probe)) {
+        ::close(probe);
+        return std::make_error_code(std::errc::address_in_use);
+    }
+    ::unlink(socketPath.c_str());
+
+    sockaddr_un address;
+    if (auto errorCode = OpenSocket(socketPath, address, listener)) {
+        return errorCode;
+    }
+    if ((::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+        || (::listen(listener, SOMAXCONN) != 0)) {
+        auto errorCode = GetLastError();
+        ::close(listener);
+        listener = -1;
+        return errorCode;
+    }
+    return {};
+}
+
+std::error_code TypoServer::Run()
+{
+    assert(listener >= 0);
+    for (;;) {
+        const auto connection = ::accept(listener, nullptr, nullptr);
+        if (connection < 0) {
+            if ((errno == EINTR) || (errno == ECONNABORTED)) {
+                continue;
+            }
+            return GetLastError();
+        }
+        {
+            std::unique_lock<std::mutex> lock(connectionMutex);
+            connectionCondition.wait(lock, [this] {
+                return connectionCount < MaxConnectionCount;
+            });
+            ++connectionCount;
+        }
+        // NOTE: The threads are detached, so the server has to live until
+        // the process exits.
+        std::thread([this, connection] {
+            Serve(connection);
+            std::lock_guard<std::mutex> lock(connectionMutex);
+            --connectionCount;
+            connectionCondition.notify_one();
+        }).detach();
+    }
+}
+
+void TypoServer::Serve(int connection)
+{
+    std::string buffer;
+    std::string line;
+    std::string response;
+    std::vector<Typo> typos;
+
+    std::error_code readError;
+    while (!(readError = ReadLine(connection, MaxRequestSize, buffer, line))) {
+        const auto fields = StringHelper::split(line, '\t');
+        response.clear();
+
+        if ((fields.size() == 2) && (fields.front() == "check")) {
+            TextPosition errorPosition;
+            typos.clear();
+            const auto errorCode = checkFile(fields[1], typos, errorPosition);
+            for (auto & typo : typos) {
+                response += "typo";
+                AppendField(response, typo.misspelledWord);
+                for (auto & correction : typo.corrections) {
+                    AppendField(response, correction);
+                }
+                response += '\n';
+            }
+            if (errorCode) {
+                response += "error";
+                AppendField(response, std::to_string(errorCode.value()));
+                AppendField(response, std::to_string(errorPosition.line));
+                AppendField(response, std::to_string(errorPosition.column));
+                response += '\n';
+            }
+            else {
+                response += "ok\n";
+            }
+        }
+        else {
+            // NOTE: The client doesn't speak this protocol.
+            break;
+        }
+
+        if (WriteAll(connection, response)) {
+            break;
+        }
+    }
+    if (readError == std::errc::message_size) {
+        response = "error";
+        AppendField(response, std::to_string(readError.value()));
+        AppendField(response, "0");
+        AppendField(response, "0");
+        response += '\n';
+        WriteAll(connection, response);
+    }
+    ::close(connection);
+}
+
+TypoClient::~TypoClient()
+{
+    if (connection >= 0) {
+        ::close(connection);
+    }
+}
+
+std::error_code TypoClient::Connect(const std::string& socketPath)
+{
+    if (connection >= 0) {
+        ::close(connection);
+        connection = -1;
+    }
+    buffer.clear();
+    return ConnectSocket(socketPath, connection);
+}
+
+std::error_code TypoClient::Request(const std::string& request)
+{
+    if (connection < 0) {
+        return std::make_error_code(std::errc::not_connected);
+    }
+    return WriteAll(connection, request);
+}
+
+std::error_code TypoClient::ReadFields(std::vector<std::string> & fields)
+{
+    std::string line;
+    // NOTE: The responses come from the server, which is trusted.
+    if (auto errorCode = ReadLine(connection, std::numeric_limits<std::size_t>::max(), buffer, line)) {
+        return errorCode;
+    }
+    fields = StringHelper::split(line, '\t');
+    return {};
+}
+
+std::error_code TypoClient::CheckFile(
+    const std::string& path,
+    std::vector<Typo>& typos,
+    TextPosition& errorPosition)
+{
+    typos.clear();
+    if (path.find_first_of("\t\n\r") != std::string::npos) {
+        return std::make_error_code(std::errc::invalid_argument);
+    }
+
+    std::string request = "check";
+    AppendField(request, path);
+    request += '\n';
+    if (auto errorCode = Request(request)) {
+        return errorCode;
+    }
+
+    std::vector<std::string> fields;
+    for (;;) {
+        if (auto errorCode = ReadFields(fields)) {
+            return errorCode;
+        }
+        if ((fields.front() == "typo") && (fields.size() >= 2)) {
+            Typo typo;
+            typo.location.filePath = path;
+            typo.misspelledWord = std::move(fields[1]);
+            for (std::size_t i = 2; i < fields.size(); ++i) {
+                typo.corrections.push_back(std::move(fields[i]));
+            }
+            typos.push_back(std::move(typo));
+            continue;
+        }
+        if ((fields.front() == "ok") && (fields.size() == 1)) {
+            return {};
+        }
+        if ((fields.front() == "error") && (fields.size() == 4)) {
+            errorPosition.line = std::strtoull(fields[2].c_str(), nullptr, 10);
+            errorPosition.column = std::strtoull(fields[3].c_str(), nullptr, 10);
+            return std::error_code(std::atoi(fields[1].c_str()), std::generic_category());
+        }
+        return std::make_error_code(std::errc::protocol_error);
+    }
+}
+
+#endif
+
+} // namespace somera
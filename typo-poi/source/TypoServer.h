@@ -0,0 +1,97 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#pragma once
+
+#include "TextReader.h"
+#include "Typo.h"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace somera {
+
+// NOTE:
+// The server and the client talk over a Unix domain socket with one line
+// per message and tab-separated fields:
+//
+//   check <path>       => typo <word> <correction>...   (zero or more)
+//                         ok
+//                       | error <errno> <line> <column>
+//
+// `<path>` is absolute because the server has its own working directory.
+// Words never contain tabs or line breaks since the segmenter splits text
+// on whitespace, and the client rejects such paths.
+
+///@brief Replaces `typos` with the typos found in the file. On a read error,
+/// `errorPosition` receives the location of an invalid UTF-8 byte.
+using CheckFileFunction = std::function<std::error_code(
+    const std::string& path,
+    std::vector<Typo>& typos,
+    TextPosition& errorPosition)>;
+
+///@brief Keeps the dictionaries loaded and answers the requests of
+/// `TypoClient` on a Unix domain socket, serving each connection on its
+/// own thread. A connection that sends a line longer than a path gets an
+/// `error` response and is closed.
+class TypoServer final {
+public:
+    explicit TypoServer(const CheckFileFunction& checkFile);
+
+    TypoServer(const TypoServer&) = delete;
+
+    TypoServer& operator=(const TypoServer&) = delete;
+
+    ~TypoServer();
+
+    ///@brief Binds the socket, replacing a stale socket file. Fails with
+    /// `address_in_use` if another server is listening on it.
+    std::error_code Listen(const std::string& socketPath);
+
+    ///@brief Accepts connections until an error occurs.
+    std::error_code Run();
+
+private:
+    void Serve(int connection);
+
+    CheckFileFunction checkFile;
+    int listener = -1;
+
+    std::mutex connectionMutex;
+    std::condition_variable connectionCondition;
+    int connectionCount = 0;
+};
+
+///@brief A connection to `TypoServer`. Requests are answered in order, so
+/// one client must not be used by several threads at once.
+class TypoClient final {
+public:
+    TypoClient() = default;
+
+    TypoClient(const TypoClient&) = delete;
+
+    TypoClient& operator=(const TypoClient&) = delete;
+
+    ~TypoClient();
+
+    std::error_code Connect(const std::string& socketPath);
+
+    ///@brief Asks the server to check the file, with the same results as
+    /// `CheckFileFunction` on the server.
+    std::error_code CheckFile(
+        const std::string& path,
+        std::vector<Typo>& typos,
+        TextPosition& errorPosition);
+
+private:
+    std::error_code Request(const std::string& request);
+
+    std::error_code ReadFields(std::vector<std::string> & fields);
+
+    int connection = -1;
+    std::string buffer;
+};
+
+} // namespace somera
@@ -1,159 +1,206 @@
 // Copyright (c) 2015 mogemimi. Distributed under the MIT license.
 
 #include "WordSegmenter.h"
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdint>
-#include <vector>
-#include <regex>
-#include <unordered_set>
+#include <iterator>
 
 namespace somera {
 namespace {
 
-bool IsSeparator(char32_t c)
-{
+enum CharacterClass : uint8_t {
+    Space = 1 << 0,
+
     // NOTE: Ascii characters without alphabet, numbers and [-'].
-    std::string separators = "!\"#$%&()*+,./:;<=>?@[\\]^`{|}~";
-    assert(std::is_sorted(separators.begin(), separators.end()));
-    return std::binary_search(std::begin(separators), std::end(separators), c);
+    Separator = 1 << 1,
+
+    Concatenator = 1 << 2,
+    Digit = 1 << 3,
+    HexDigit = 1 << 4,
+
+    // NOTE: [A-Za-z0-9_]
+    WordCharacter = 1 << 5,
+};
+
+using CharacterClassTable = std::array<uint8_t, 256>;
+
+void AddClass(CharacterClassTable & table, const char* characters, uint8_t characterClass)
+{
+    for (; *characters != '\0'; ++characters) {
+        table[static_cast<uint8_t>(*characters)] |= characterClass;
+    }
 }
 
-bool IsConcatenator(char32_t c)
+CharacterClassTable MakeCharacterClassTable()
 {
-    std::string separators = "'-";
-    assert(std::is_sorted(separators.begin(), separators.end()));
-    return std::binary_search(std::begin(separators), std::end(separators), c);
+    CharacterClassTable table;
+    table.fill(0);
+    AddClass(table, " \t\n\v\f\r", Space);
+    AddClass(table, "!\"#$%&()*+,./:;<=>?@[\\]^`{|}~", Separator);
+    AddClass(table, "'-", Concatenator);
+    AddClass(table, "0123456789", Digit | HexDigit | WordCharacter);
+    AddClass(table, "abcdefABCDEF", HexDigit);
+    AddClass(table, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_", WordCharacter);
+    return table;
 }
 
-std::vector<std::tuple<std::string, PartOfSpeechTag>> SplitBySpace(const std::string& str)
+const CharacterClassTable characterClasses = MakeCharacterClassTable();
+
+bool HasClass(char c, uint8_t characterClass) noexcept
 {
-    std::vector<std::tuple<std::string, PartOfSpeechTag>> tokens;
-    std::string buffer;
-    std::string separator;
-    auto flushBuffer = [&] {
-        if (!buffer.empty()) {
-            tokens.emplace_back(buffer, PartOfSpeechTag::Word);
-            buffer.clear();
-        }
-    };
-    auto flushSeparator = [&] {
-        if (!separator.empty()) {
-            tokens.emplace_back(separator, PartOfSpeechTag::Spaces);
-            separator.clear();
-        }
-    };
-
-    auto iter = str.begin();
-    auto end = str.end();
-    for (; iter != end; ++iter) {
-        auto character = *iter;
-        if (::isspace(character)) {
-            flushBuffer();
-            separator += character;
-        }
-        else {
-            flushSeparator();
-            buffer += character;
+    return (characterClasses[static_cast<uint8_t>(c)] & characterClass) != 0;
+}
+
+bool StartsWith(const char* first, const char* last, const char* prefix) noexcept
+{
+    for (; *prefix != '\0'; ++prefix, ++first) {
+        if ((first == last) || (*first != *prefix)) {
+            return false;
         }
     }
-    assert(buffer.empty() || separator.empty());
-    flushBuffer();
-    flushSeparator();
-    return tokens;
+    return true;
 }
 
-void TokenizeByAsciiSymbols(
-    const std::string& str,
-    std::function<void(const PartOfSpeech&)> callback)
+const char* SkipClass(const char* first, const char* last, uint8_t characterClass) noexcept
+{
+    while ((first != last) && HasClass(*first, characterClass)) {
+        ++first;
+    }
+    return first;
+}
+
+bool IsGitUrl(const char* first, const char* last) noexcept
 {
-    std::string buffer;
-    std::string separator;
+    // NOTE: git@\w+\..+
+    if (!StartsWith(first, last, "git@")) {
+        return false;
+    }
+    const auto host = first + 4;
+    const auto dot = SkipClass(host, last, WordCharacter);
+    return (dot != host) && (dot != last) && (*dot == '.') && (std::next(dot) != last);
+}
 
-    auto flushBuffer = [&] {
-        if (buffer.empty()) {
-            return;
+bool IsUrl(const char* first, const char* last) noexcept
+{
+    // NOTE: (http|https|ftp)://.+
+    for (auto scheme : {"http://", "https://", "ftp://"}) {
+        if (StartsWith(first, last, scheme)
+            && (static_cast<std::size_t>(last - first) > std::char_traits<char>::length(scheme))) {
+            return true;
         }
+    }
+    return false;
+}
 
-        auto trimRight = std::find_if(std::rbegin(buffer), std::rend(buffer),
-            [&](char32_t c){ return !IsConcatenator(c); }).base();
+PartOfSpeechTag ClassifyWord(const char* first, const char* last) noexcept
+{
+    assert(first != last);
 
-        std::string prefix(std::begin(buffer), trimRight);
-        std::string suffix(trimRight, std::end(buffer));
-        buffer.clear();
+    // NOTE: \d+
+    if (SkipClass(first, last, Digit) == last) {
+        return PartOfSpeechTag::Integer;
+    }
 
-        if (std::regex_match(prefix, std::regex(R"(\d+)"))) {
-            // integer
-            callback({prefix, PartOfSpeechTag::Integer});
-        }
-        else if (std::regex_match(prefix, std::regex(R"(0x[\dA-Fa-f]+)"))) {
-            // hex integer
-            callback({prefix, PartOfSpeechTag::IntegerHex});
-        }
-        else if (std::regex_match(prefix, std::regex(R"(0b[01]+)"))) {
-            // binary integer
-            callback({prefix, PartOfSpeechTag::IntegerBinary});
-        }
-        else if (std::regex_match(prefix, std::regex(R"((\d*\.\d+|\d+\.\d*)f?)"))) {
-            // float number
-            callback({prefix, PartOfSpeechTag::FloatNumber});
-        }
-        else {
-            callback({prefix, PartOfSpeechTag::Word});
-        }
+    // NOTE: 0x[\dA-Fa-f]+
+    if (StartsWith(first, last, "0x") && (last - first > 2)
+        && (SkipClass(first + 2, last, HexDigit) == last)) {
+        return PartOfSpeechTag::IntegerHex;
+    }
 
-        if (!suffix.empty()) {
-            callback({suffix, PartOfSpeechTag::Symbol});
-        }
-    };
-    auto flushSeparator = [&] {
-        if (!separator.empty()) {
-            callback({separator, PartOfSpeechTag::Spaces});
-            separator.clear();
-        }
-    };
-
-    auto iter = str.begin();
-    auto end = str.end();
-    for (; iter != end; ++iter) {
-        auto character = *iter;
-        if ((IsSeparator(character)) || (buffer.empty() && IsConcatenator(character))) {
-            flushBuffer();
-            separator += character;
+    // NOTE: 0b[01]+
+    if (StartsWith(first, last, "0b") && (last - first > 2)
+        && std::all_of(first + 2, last, [](char c) { return c == '0' || c == '1'; })) {
+        return PartOfSpeechTag::IntegerBinary;
+    }
+
+    // NOTE: (\d*\.\d+|\d+\.\d*)f?
+    auto end = last;
+    if (*std::prev(end) == 'f') {
+        --end;
+    }
+    const auto dot = SkipClass(first, end, Digit);
+    if ((dot != end) && (*dot == '.')) {
+        const auto fraction = std::next(dot);
+        if ((SkipClass(fraction, end, Digit) == end) && ((dot != first) || (fraction != end))) {
+            return PartOfSpeechTag::FloatNumber;
         }
-        else {
-            flushSeparator();
-            buffer += character;
+    }
+    return PartOfSpeechTag::Word;
+}
+
+void EmitWord(
+    const char* first,
+    const char* last,
+    const std::function<void(const PartOfSpeech&)>& callback)
+{
+    assert(first != last);
+
+    // NOTE: Trailing concatenators, such as "--" in "foo--", become a symbol.
+    auto trimRight = last;
+    while ((trimRight != first) && HasClass(*std::prev(trimRight), Concatenator)) {
+        --trimRight;
+    }
+    assert(trimRight != first);
+
+    callback({StringView(first, trimRight - first), ClassifyWord(first, trimRight)});
+    if (trimRight != last) {
+        callback({StringView(trimRight, last - trimRight), PartOfSpeechTag::Symbol});
+    }
+}
+
+void TokenizeByAsciiSymbols(
+    const char* first,
+    const char* last,
+    const std::function<void(const PartOfSpeech&)>& callback)
+{
+    auto iter = first;
+    while (iter != last) {
+        // NOTE: A word never starts with a concatenator.
+        const auto separatorEnd = SkipClass(iter, last, Separator | Concatenator);
+        if (separatorEnd != iter) {
+            callback({StringView(iter, separatorEnd - iter), PartOfSpeechTag::Spaces});
+            iter = separatorEnd;
+            continue;
         }
+        const auto wordEnd = std::find_if(iter, last, [](char c) {
+            return HasClass(c, Separator);
+        });
+        EmitWord(iter, wordEnd, callback);
+        iter = wordEnd;
     }
-    assert(buffer.empty() || separator.empty());
-    flushBuffer();
-    flushSeparator();
 }
 
 } // end anonymous namespace
 
 void WordSegmenter::Parse(
-    const std::string& str,
-    std::function<void(const PartOfSpeech&)> callback)
+    StringView text,
+    const std::function<void(const PartOfSpeech&)>& callback)
 {
-    auto splitStrings = SplitBySpace(str);
-
-    for (auto & tuple : splitStrings) {
-        auto & text = std::get<0>(tuple);
-        auto & tag = std::get<1>(tuple);
-        if (tag == PartOfSpeechTag::Spaces) {
-            callback(PartOfSpeech{text, PartOfSpeechTag::Spaces});
+    auto iter = text.begin();
+    const auto last = text.end();
+    while (iter != last) {
+        const auto spaceEnd = SkipClass(iter, last, Space);
+        if (spaceEnd != iter) {
+            callback({StringView(iter, spaceEnd - iter), PartOfSpeechTag::Spaces});
+            iter = spaceEnd;
             continue;
         }
-        if (std::regex_match(text, std::regex(R"(git@\w+\..+)"))) {
-            callback(PartOfSpeech{text, PartOfSpeechTag::GitUrl});
-            continue;
+
+        const auto wordEnd = std::find_if(iter, last, [](char c) {
+            return HasClass(c, Space);
+        });
+        if (IsGitUrl(iter, wordEnd)) {
+            callback({StringView(iter, wordEnd - iter), PartOfSpeechTag::GitUrl});
         }
-        if (std::regex_match(text, std::regex(R"((http|https|ftp)://.+)"))) {
-            callback(PartOfSpeech{text, PartOfSpeechTag::Url});
-            continue;
+        else if (IsUrl(iter, wordEnd)) {
+            callback({StringView(iter, wordEnd - iter), PartOfSpeechTag::Url});
+        }
+        else {
+            TokenizeByAsciiSymbols(iter, wordEnd, callback);
         }
-        TokenizeByAsciiSymbols(text, callback);
+        iter = wordEnd;
     }
 }
 
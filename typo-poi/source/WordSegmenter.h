@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "somera/StringView.h"
 #include <functional>
 #include <string>
 
@@ -20,15 +21,17 @@ enum class PartOfSpeechTag {
 };
 
 struct PartOfSpeech {
-    std::string text;
+    ///@brief A view into the text passed to `WordSegmenter::Parse`.
+    StringView text;
     PartOfSpeechTag tag;
 };
 
 class WordSegmenter {
 public:
+    ///@brief Splits the text into tokens without allocating memory.
     void Parse(
-        const std::string& text,
-        std::function<void(const PartOfSpeech&)> callback);
+        StringView text,
+        const std::function<void(const PartOfSpeech&)>& callback);
 };
 
 } // namespace somera
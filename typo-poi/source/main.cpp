@@ -1,18 +1,29 @@
 // Copyright (c) 2016 mogemimi. Distributed under the MIT license.
 
 #include "ConsoleColor.h"
-#include "Replacement.h"
+#include "GitDiff.h"
+#include "MemoryMappedFile.h"
+#include "ScanResultCache.h"
+#include "TextReader.h"
+#include "TokenTable.h"
 #include "Typo.h"
+#include "TypoServer.h"
 #include "WordDiff.h"
 #include "WordSegmenter.h"
 #include "somera/CommandLineParser.h"
 #include "somera/FileSystem.h"
 #include "somera/Optional.h"
+#include "somera/ParallelFor.h"
 #include "somera/StringHelper.h"
-#include "thirdparty/ConvertUTF.h"
 #include <iostream>
-#include <fstream>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 using somera::CommandLineParser;
 using somera::Optional;
@@ -29,262 +40,161 @@ void SetupCommandLineParser(CommandLineParser & parser)
     parser.addArgument("-help", Type::Flag, "Display available options");
     parser.addArgument("-v", Type::Flag, "Display version");
     parser.addArgument("-dict", Type::JoinedOrSeparate, "Dictionary file");
+    parser.addArgument("-engine", Type::JoinedOrSeparate, "Spell checker engine (signature, symspell or dawg)");
+    parser.addArgument("-j", Type::JoinedOrSeparate, "Number of threads used to scan files");
+    parser.addArgument("-compile-dict", Type::JoinedOrSeparate, "Compile the -dict files into a memory-mappable dictionary");
+    parser.addArgument("-cache", Type::JoinedOrSeparate, "Cache file of the typos found in each file, used to skip unchanged files");
+    parser.addArgument("-stats", Type::Flag, "Print the counters and timings of each stage to stderr at exit");
+    parser.addArgument("-server", Type::JoinedOrSeparate, "Keep the dictionaries loaded and serve checks on a Unix domain socket");
+    parser.addArgument("-connect", Type::JoinedOrSeparate, "Check the files with the server listening on the socket");
+    parser.addArgument("-diff", Type::JoinedOrSeparate, "Check only the lines changed since the git revision");
+    parser.addArgument("-lex-cxx", Type::Flag, "Check only the comments, string literals and identifiers of C/C++ files");
 }
 
-struct UTF8Character {
-    std::string buffer;
-    somera::SourceRange byteRange;
-    std::size_t column = 0;
-    std::size_t line = 0;
-};
-
-class UTF8Chunk {
-public:
-    UTF8Chunk()
-    {
-    }
-
-    UTF8Chunk(UTF8Chunk && other)
-    {
-        buffer = std::move(other.buffer);
-        byteRange = std::move(other.byteRange);
-        range = std::move(other.range);
-    }
-
-    UTF8Chunk & operator=(UTF8Chunk && other)
-    {
-        buffer = std::move(other.buffer);
-        byteRange = std::move(other.byteRange);
-        range = std::move(other.range);
-        return *this;
-    }
-
-    UTF8Chunk& operator+=(const UTF8Character& c)
-    {
-        if (buffer.empty()) {
-            assert(byteRange.GetOffset() == 0);
-            assert(byteRange.GetLength() == 0);
-            buffer = c.buffer;
-            byteRange = somera::SourceRange(
-                c.byteRange.GetOffset(),
-                c.byteRange.GetLength());
-            range = somera::SourceRange(c.column, 1);
-            return *this;
-        }
-
-        assert(!buffer.empty());
-        assert(buffer.size() == byteRange.GetLength());
-        assert(!byteRange.Contains(c.byteRange));
-        assert(byteRange.GetLength() > 0 && range.GetLength() > 0);
-        assert(byteRange.GetOffset() + byteRange.GetLength() == c.byteRange.GetOffset());
-        assert(range.GetOffset() + range.GetLength() == c.column);
-
-        buffer += c.buffer;
-        byteRange = somera::SourceRange(
-            byteRange.GetOffset(),
-            byteRange.GetLength() + c.byteRange.GetLength());
-        range = somera::SourceRange(
-            range.GetOffset(),
-            range.GetLength() + 1);
-        return *this;
-    }
-
-    std::string GetString() const noexcept
-    {
-        return buffer;
-    }
-
-    bool Empty() const noexcept
-    {
-        assert(buffer.empty()
-            ? (byteRange.GetLength() == 0 && range.GetLength() == 0)
-            : (byteRange.GetLength() > 0 && range.GetLength() > 0));
-        return buffer.empty();
-    }
-
-    void Clear() noexcept
-    {
-        buffer.clear();
-        byteRange = somera::SourceRange(0, 0);
-        range = somera::SourceRange(0, 0);
-    }
-
-private:
-    std::string buffer;
-    somera::SourceRange byteRange;
-    somera::SourceRange range;
-};
-
 void ReadDictionaryFile(
     const std::string& path,
     const std::function<void(const std::string&)>& callback)
 {
-    std::error_code errorCode;
-    const auto fileSize = somera::FileSystem::getFileSize(path, errorCode);
-
-    if (errorCode) {
+    somera::MemoryMappedFile file;
+    if (file.Open(path)) {
         std::cerr << "error: Cannot found the file. " << path << std::endl;
         return;
     }
-    if (fileSize >= std::numeric_limits<int32_t>::max()) {
-        // TODO: We cannot read a file larger than 2GB.
-        std::cerr << "error: File is too large to read. " << path << std::endl;
-        return;
-    }
-
-    std::ifstream input(path, std::ios::binary);
-    if (!input) {
-        return;
-    }
-
-    std::istreambuf_iterator<char> start(input);
-    std::istreambuf_iterator<char> end;
 
+    // NOTE: Each line of a dictionary is a word.
+    const auto last = file.GetData() + file.GetSize();
+    auto wordFirst = file.GetData();
     std::string word;
-    for (; start != end; ++start) {
-        auto c = *start;
-        if (c == '\r' || c == '\n' || c == '\0') {
-            if (!word.empty()) {
+    for (auto p = wordFirst; p != last; ++p) {
+        if (*p == '\r' || *p == '\n' || *p == '\0') {
+            if (p != wordFirst) {
+                word.assign(wordFirst, p);
                 callback(word);
             }
-            word.clear();
-            continue;
+            wordFirst = p + 1;
         }
-        word += c;
     }
-    if (!word.empty()) {
+    if (wordFirst != last) {
+        word.assign(wordFirst, last);
         callback(word);
     }
 }
 
-void ReadUTF8TextFile(
-    const std::string& path, const std::function<void(UTF8Character&&)>& callback)
+bool IsCxxSourceFile(const std::string& path)
 {
-    std::error_code errorCode;
-    auto fileSize = somera::FileSystem::getFileSize(path, errorCode);
+    // NOTE: The extension is returned without the dot.
+    auto ext = std::get<1>(somera::FileSystem::splitExtension(path));
+    return ext == "c"
+        || ext == "cc"
+        || ext == "cpp"
+        || ext == "cxx"
+        || ext == "h"
+        || ext == "hh"
+        || ext == "hpp"
+        || ext == "hxx"
+        || ext == "inl"
+        || ext == "m"
+        || ext == "mm";
+}
 
-    if (fileSize >= std::numeric_limits<int32_t>::max()) {
-        // TODO: We cannot read a file larger than 2GB.
-        std::cerr << "error: File is too large to read. " << path << std::endl;
-        return;
-    }
+bool IsLexedAsCxx(const std::string& path, bool isCxxLexed)
+{
+    return isCxxLexed && IsCxxSourceFile(path);
+}
 
-    std::ifstream input(path, std::ios::binary);
-    if (!input) {
-        return;
+///@brief Computes the key of the file in a `ScanResultCache`.
+///
+/// The same contents give different typos when they are lexed as C/C++ and
+/// when they are read as text, such as "a.cpp" and a copy named "a.txt",
+/// so the key includes how the file is read.
+std::error_code ComputeScanResultKey(
+    const std::string& path,
+    bool isCxxLexed,
+    somera::ContentHash& contentHash)
+{
+    if (auto errorCode = somera::ComputeFileContentHash(path, contentHash)) {
+        return errorCode;
     }
+    const char readMode = IsLexedAsCxx(path, isCxxLexed) ? 'c' : 't';
+    contentHash.hash = somera::HashBytes(contentHash.hash, &readMode, sizeof(readMode));
+    return {};
+}
 
-    std::istreambuf_iterator<char> start(input);
-    std::istreambuf_iterator<char> end;
-    std::size_t byteIndex = 0;
-    std::size_t utf8CharacterCount = 0;
-    std::size_t lineCount = 1;
-    std::size_t columnCount = 0;
-
-    while (input && (byteIndex < fileSize)) {
-        std::array<UTF8, 5> buffer;
-        std::fill(std::begin(buffer), std::end(buffer), 0);
-
-        const auto readableSize = std::min<std::size_t>(4, fileSize - byteIndex);
-        assert(readableSize <= buffer.size());
-        assert(byteIndex + readableSize <= fileSize);
-        input.read(reinterpret_cast<char*>(buffer.data()), readableSize);
-
-        auto source = buffer.data();
-        auto sourceEnd = buffer.data() + readableSize;
-
-        if (!isLegalUTF8Sequence(source, sourceEnd)) {
-            // Error: Invalid UTF-8 byte sequence
-            std::cerr
-                << "error: Invalid UTF-8 byte sequence at "
-                << path
-                << ":"
-                << lineCount
-                << ":"
-                << columnCount
-                << "."
-                << std::endl;
-            break;
-        }
-
-        const auto readBytes = getNumBytesForUTF8(buffer.front());
-
-        assert(readBytes <= readableSize);
-        assert((byteIndex + readBytes) <= fileSize);
-
-        UTF8Character character;
-        character.buffer.assign(reinterpret_cast<char*>(buffer.data()), readBytes);
-        character.column = columnCount;
-        character.line = lineCount;
-        character.byteRange = somera::SourceRange(byteIndex, readBytes);
-
-        assert(callback);
-        callback(std::move(character));
-
-        byteIndex += readBytes;
-        utf8CharacterCount++;
-        columnCount++;
-
-        if (readBytes < readableSize) {
-            input.seekg(byteIndex, std::ios_base::beg);
-        }
-
-        if (buffer.front() == '\n') {
-            lineCount++;
-            columnCount = 0;
+///@brief Calls `callback(sentence, line)` for each sentence of the file, or
+/// only of the lines in `lineRanges` unless it is `nullptr`.
+///
+/// With `isCxxLexed`, the C/C++ files are lexed so that only their
+/// comments, string literals and identifiers are read.
+std::error_code ReadSentences(
+    const std::string& path,
+    const std::vector<somera::LineRange>* lineRanges,
+    bool isCxxLexed,
+    const std::function<void(somera::StringView sentence, std::size_t line)>& callback,
+    somera::TextPosition& errorPosition)
+{
+    somera::WordSegmenter segmenter;
+    auto onWord = [&](const somera::WordView& word) {
+        segmenter.Parse(word.text, [&](const somera::PartOfSpeech& pos) {
+            callback(pos.text, word.position.line);
+        });
+    };
+    if (IsLexedAsCxx(path, isCxxLexed)) {
+        if (lineRanges != nullptr) {
+            return somera::ReadWordsFromSourceLines(path, *lineRanges, onWord, errorPosition);
         }
+        return somera::ReadWordsFromSourceFile(path, onWord, errorPosition);
     }
+    if (lineRanges != nullptr) {
+        return somera::ReadWordsFromTextLines(path, *lineRanges, onWord, errorPosition);
+    }
+    return somera::ReadWordsFromTextFile(path, onWord, errorPosition);
 }
 
-bool IsSpace(const std::string& c)
+std::error_code ReadTextFileWithoutPedanticMode(
+    somera::TypoMan & typos,
+    const std::string& path,
+    bool isCxxLexed,
+    somera::TextPosition& errorPosition)
 {
-    if (c.size() == 1) {
-        return ::isspace(c.front()) != 0;
-    }
-    if (c == "\xE3\x80\x80") {
-        return true;
-    }
-    return false;
+    somera::TypoSource source;
+    source.location.filePath = path;
+    return ReadSentences(path, nullptr, isCxxLexed, [&](somera::StringView sentence, std::size_t line) {
+        source.location.line = line;
+        typos.computeFromSentence(sentence, source);
+    }, errorPosition);
 }
 
-void ReadTextFileWithoutPedanticMode(somera::TypoMan & typos, const std::string& path)
+void PrintReadError(
+    const std::error_code& errorCode,
+    const std::string& path,
+    const somera::TextPosition& errorPosition)
 {
-    auto onWord = [&](const std::string& sourceString) {
-        somera::TypoSource source;
-        source.location.filePath = path;
-        typos.computeFromSentence(sourceString, source);
-    };
-    auto flush = [&](UTF8Chunk && chunk) {
-        somera::WordSegmenter segmenter;
-        segmenter.parse(chunk.GetString(), [&](const somera::PartOfSpeech& word) {
-            onWord(word.text);
-        });
-    };
-    UTF8Chunk currentLine;
-    UTF8Chunk word;
-    ReadUTF8TextFile(path, [&](UTF8Character && character) {
-        currentLine += character;
-        if (IsSpace(character.buffer)) {
-            if (!word.Empty()) {
-                UTF8Chunk temp;
-                std::swap(word, temp);
-                flush(std::move(temp));
-            }
-            currentLine.Clear();
-            return;
-        }
-        word += character;
-    });
+    if (errorCode == std::errc::illegal_byte_sequence) {
+        std::cerr
+            << "error: Invalid UTF-8 byte sequence at "
+            << path
+            << ":"
+            << errorPosition.line
+            << ":"
+            << errorPosition.column
+            << "."
+            << std::endl;
+    }
+    else if (errorCode) {
+        std::cerr << "error: " << errorCode.message() << ", " << path << std::endl;
+    }
 }
 
-void showTypoInConsole(const somera::Typo& typo)
+std::string formatTypoForConsole(const somera::Typo& typo)
 {
     const auto& misspelledWord = typo.misspelledWord;
     const auto& corrections = typo.corrections;
     if (corrections.empty()) {
-        return;
+        return {};
     }
 
+    std::string output;
+
     using somera::DiffOperation;
     using somera::TerminalColor;
     {
@@ -321,14 +231,14 @@ void showTypoInConsole(const somera::Typo& typo)
         for (int i = indentSpaces - static_cast<int>(correction.size()); i > 0; --i) {
             toStream << " ";
         }
-        std::printf("%s => %s", fromStream.str().c_str(), toStream.str().c_str());
+        output += fromStream.str() + " => " + toStream.str();
     }
 
     if (corrections.size() > 1) {
-        std::printf(" (");
+        output += " (";
         for (size_t i = 1; i < corrections.size(); ++i) {
             if (i > 1) {
-                std::printf(" ");
+                output += " ";
             }
             auto & correction = corrections[i];
             auto hunks = somera::computeDiff(misspelledWord, correction);
@@ -344,11 +254,548 @@ void showTypoInConsole(const somera::Typo& typo)
                         TerminalColor::Blue);
                 }
             }
-            std::printf("%s", toStream.str().c_str());
+            output += toStream.str();
         }
-        std::printf(")");
+        output += ")";
+    }
+    output += "\n";
+    return output;
+}
+
+void showTypoInConsole(const somera::Typo& typo, bool isLocationShown)
+{
+    auto output = formatTypoForConsole(typo);
+    if (isLocationShown && !output.empty()) {
+        output = typo.location.filePath + ":" + std::to_string(typo.location.line) + ": " + output;
+    }
+    std::fputs(output.c_str(), stdout);
+}
+
+bool IsIgnoredFile(const std::string& path)
+{
+    auto ext = std::get<1>(somera::FileSystem::splitExtension(path));
+    return ext == ".png"
+        || ext == ".jpg"
+        || ext == "exe"
+        || ext == ".DS_Store"
+        || ext == ".o"
+        || ext == ".a"
+        || ext == ".d"
+        || ext == ".lib"
+        || ext == ".dll";
+}
+
+void SetupTypoMan(somera::TypoMan & typos)
+{
+    typos.setStrictWhiteSpace(false);
+    typos.setStrictHyphen(false);
+    typos.setMinimumWordSize(3);
+    typos.setMaxCorrectWordCount(4);
+    typos.setCacheEnabled(true);
+    typos.setCacheSize(100);
+}
+
+uint64_t ComputeDictionaryFingerprint(
+    const std::string& engineName,
+    const std::vector<std::string>& dictionaryPaths)
+{
+    // NOTE: -lex-cxx is part of the key of each file (see `ComputeScanResultKey`).
+    auto fingerprint = somera::HashBytes(somera::InitialContentHash, engineName.data(), engineName.size());
+    for (auto & path : dictionaryPaths) {
+        // NOTE: A missing dictionary keeps its initial hash, which still
+        // differs from any readable contents.
+        somera::ContentHash contentHash;
+        somera::ComputeFileContentHash(path, contentHash);
+        fingerprint = somera::HashBytes(fingerprint,
+            reinterpret_cast<const char*>(&contentHash.hash), sizeof(contentHash.hash));
+        fingerprint = somera::HashBytes(fingerprint,
+            reinterpret_cast<const char*>(&contentHash.size), sizeof(contentHash.size));
+    }
+    return fingerprint;
+}
+
+void PrintStats(const somera::TypoManStats& typoStats, const somera::SpellCheckerStats& spellStats)
+{
+    auto percent = [](double count, double total) {
+        return (total > 0) ? (count * 100.0 / total) : 0.0;
+    };
+
+    std::fprintf(stderr, "typo-poi stats:\n");
+    std::fprintf(stderr, "  sentences:          %zu\n", typoStats.sentenceCount);
+    std::fprintf(stderr, "  words:              %zu\n", typoStats.wordCount);
+    std::fprintf(stderr, "  short words:        %zu (%.1f%%)\n",
+        typoStats.shortWordCount, percent(typoStats.shortWordCount, typoStats.wordCount));
+    std::fprintf(stderr, "  cache hits:         %zu\n", typoStats.cacheHitCount);
+    std::fprintf(stderr, "  suggest calls:      %zu\n", typoStats.suggestCount);
+    std::fprintf(stderr, "  typos:              %zu\n", typoStats.typoCount);
+    std::fprintf(stderr, "  segmentation:       %.3f s\n", typoStats.segmentationSeconds);
+    std::fprintf(stderr, "  cache:              %.3f s\n", typoStats.cacheSeconds);
+    std::fprintf(stderr, "  suggest:            %.3f s\n", typoStats.suggestSeconds);
+    std::fprintf(stderr, "  diff filter:        %.3f s\n", typoStats.diffFilterSeconds);
+
+    if (spellStats.queryCount == 0) {
+        // NOTE: The engine doesn't collect stats.
+        return;
     }
-    std::printf("\n");
+    std::fprintf(stderr, "spell checker stats:\n");
+    std::fprintf(stderr, "  queries:            %llu\n",
+        static_cast<unsigned long long>(spellStats.queryCount));
+    std::fprintf(stderr, "  exact hits:         %llu\n",
+        static_cast<unsigned long long>(spellStats.exactHitCount));
+    std::fprintf(stderr, "  bucket lookups:     %llu (%.1f%% found)\n",
+        static_cast<unsigned long long>(spellStats.bucketLookupCount),
+        percent(spellStats.bucketHitCount, spellStats.bucketLookupCount));
+    std::fprintf(stderr, "  candidates:         %llu\n",
+        static_cast<unsigned long long>(spellStats.candidateCount));
+    std::fprintf(stderr, "  scored candidates:  %llu (%.1f%%)\n",
+        static_cast<unsigned long long>(spellStats.scoredCandidateCount),
+        percent(spellStats.scoredCandidateCount, spellStats.candidateCount));
+    std::fprintf(stderr, "  probe:              %.3f s\n", spellStats.probeSeconds);
+    std::fprintf(stderr, "  identifier parts:   %.3f s\n", spellStats.identifierSeconds);
+    std::fprintf(stderr, "  word separation:    %.3f s\n", spellStats.separationSeconds);
+    std::fprintf(stderr, "  ranking:            %.3f s\n", spellStats.rankingSeconds);
+}
+
+///@brief Finds the typos of one file at a time for a worker of
+/// `ScanFilesInParallel`.
+class FileScanner {
+public:
+    virtual ~FileScanner() = default;
+
+    ///@brief Replaces `typos` with every typo found in the file.
+    virtual std::error_code Scan(
+        const std::string& path,
+        std::vector<somera::Typo>& typos,
+        somera::TextPosition& errorPosition) = 0;
+
+    virtual somera::TypoManStats GetStats() const
+    {
+        return {};
+    }
+};
+
+class LocalFileScanner final : public FileScanner {
+public:
+    LocalFileScanner(
+        const std::shared_ptr<somera::SpellChecker>& spellChecker,
+        bool isStatsEnabled,
+        bool isCxxLexedIn)
+        : typos(spellChecker)
+        , isCxxLexed(isCxxLexedIn)
+    {
+        SetupTypoMan(typos);
+        typos.setCacheEnabled(false);
+        typos.setStatsEnabled(isStatsEnabled);
+        typos.setFoundCallback([this](const somera::Typo& typo) {
+            found->push_back(typo);
+        });
+    }
+
+    LocalFileScanner(const LocalFileScanner&) = delete;
+
+    LocalFileScanner& operator=(const LocalFileScanner&) = delete;
+
+    std::error_code Scan(
+        const std::string& path,
+        std::vector<somera::Typo>& typosOut,
+        somera::TextPosition& errorPosition) override
+    {
+        typosOut.clear();
+        found = &typosOut;
+        auto errorCode = ReadTextFileWithoutPedanticMode(typos, path, isCxxLexed, errorPosition);
+        found = nullptr;
+        return errorCode;
+    }
+
+    somera::TypoManStats GetStats() const override
+    {
+        return typos.getStats();
+    }
+
+private:
+    somera::TypoMan typos;
+    std::vector<somera::Typo>* found = nullptr;
+    bool isCxxLexed;
+};
+
+class RemoteFileScanner final : public FileScanner {
+public:
+    std::error_code Connect(const std::string& socketPath)
+    {
+        return client.Connect(socketPath);
+    }
+
+    std::error_code Scan(
+        const std::string& path,
+        std::vector<somera::Typo>& typos,
+        somera::TextPosition& errorPosition) override
+    {
+        // NOTE: The server has its own working directory.
+        if (somera::FileSystem::isAbsolute(path)) {
+            return client.CheckFile(path, typos, errorPosition);
+        }
+        return client.CheckFile(somera::FileSystem::join(currentDirectory, path), typos, errorPosition);
+    }
+
+private:
+    somera::TypoClient client;
+    std::string currentDirectory = somera::FileSystem::getCurrentDirectory();
+};
+
+///@brief The changed lines of each file, for `-diff`.
+using ChangedLines = std::unordered_map<std::string, std::vector<somera::LineRange>>;
+
+void ScanFilesByUniqueWords(
+    const std::vector<std::string>& paths,
+    const std::shared_ptr<somera::SpellChecker>& spellChecker,
+    int threadCount,
+    const ChangedLines* changedLines,
+    bool isCxxLexed,
+    somera::ScanResultCache* resultCache,
+    somera::TypoManStats* stats,
+    bool isLocationShown)
+{
+    // NOTE:
+    // Identifiers repeat thousands of times across a codebase, so the files
+    // are scanned in three phases to spell check each unique word once:
+    //
+    //   1. Splits the files into words on the worker threads. Each worker
+    //      interns the words into its own token table, and each file keeps
+    //      its sequence of token occurrences.
+    //   2. Merges the tables and spell checks the unique tokens in one
+    //      batch, which the spell checker splits across the threads.
+    //   3. Fans the typos out to their occurrences, and replays them through
+    //      the typo cache in path order, so the output is the same as
+    //      checking the files one by one.
+    //
+    // The typos of a whole file don't depend on the other files, so they can
+    // also come from `resultCache` when the file is unchanged.
+    struct ScannedFile {
+        std::vector<somera::TokenOccurrence> occurrences;
+        std::vector<somera::Typo> cachedTypos;
+        somera::ContentHash contentHash;
+        somera::TextPosition errorPosition;
+        std::error_code errorCode;
+        int worker = 0;
+        bool isCached = false;
+        bool isCacheable = false;
+    };
+    std::vector<ScannedFile> files(paths.size());
+    std::vector<somera::TokenTable> workerTables(threadCount);
+    std::vector<somera::TypoMan> workerTypos;
+    std::mutex mutex;
+
+    workerTypos.reserve(threadCount);
+    for (int worker = 0; worker < threadCount; ++worker) {
+        workerTypos.emplace_back(spellChecker);
+        auto & typos = workerTypos.back();
+        SetupTypoMan(typos);
+        typos.setCacheEnabled(false);
+        typos.setStatsEnabled(stats != nullptr);
+    }
+
+    somera::ParallelFor(threadCount, paths.size(), [&](int worker, std::size_t index) {
+        auto & file = files[index];
+        file.worker = worker;
+        if (resultCache != nullptr) {
+            file.isCacheable = !ComputeScanResultKey(paths[index], isCxxLexed, file.contentHash);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (file.isCacheable) {
+                if (auto cached = resultCache->Find(file.contentHash)) {
+                    file.cachedTypos = *cached;
+                    file.isCached = true;
+                    return;
+                }
+            }
+        }
+
+        const std::vector<somera::LineRange>* lineRanges = nullptr;
+        if (changedLines != nullptr) {
+            auto iter = changedLines->find(paths[index]);
+            assert(iter != std::end(*changedLines));
+            lineRanges = &iter->second;
+        }
+
+        auto & typos = workerTypos[worker];
+        auto & table = workerTables[worker];
+        file.errorCode = ReadSentences(paths[index], lineRanges, isCxxLexed,
+            [&](somera::StringView sentence, std::size_t line) {
+                typos.collectWords(sentence, [&](somera::StringView word) {
+                    file.occurrences.push_back(somera::TokenOccurrence{
+                        table.Intern(word), static_cast<uint32_t>(line)});
+                });
+            },
+            file.errorPosition);
+
+        // NOTE: Files with errors are not cached, so the errors are reported again.
+        if (file.errorCode) {
+            file.isCacheable = false;
+        }
+    });
+
+    somera::TokenTable table;
+    for (int worker = 0; worker < threadCount; ++worker) {
+        const auto tokens = table.Merge(workerTables[worker]);
+        workerTables[worker] = somera::TokenTable{};
+        for (auto & file : files) {
+            if (file.worker != worker) {
+                continue;
+            }
+            for (auto & occurrence : file.occurrences) {
+                occurrence.token = tokens[occurrence.token];
+            }
+        }
+    }
+
+    // NOTE:
+    // The unique tokens go to the spell checker in one batch, which shares
+    // the bucket walks between them and splits them across the threads.
+    // Only the misspelled tokens have corrections to filter like
+    // `computeFromWord`, so the filtering runs on this thread.
+    std::vector<std::string> tokenTexts;
+    tokenTexts.reserve(table.GetSize());
+    for (std::size_t token = 0; token < table.GetSize(); ++token) {
+        tokenTexts.push_back(table.GetText(static_cast<somera::TokenId>(token)));
+    }
+    const auto suggestStart = std::chrono::steady_clock::now();
+    auto suggestResults = spellChecker->SuggestWords(tokenTexts, threadCount);
+    if (stats != nullptr) {
+        stats->suggestSeconds += std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - suggestStart).count();
+    }
+
+    // NOTE: A token without corrections is spelled correctly.
+    std::vector<std::vector<std::string>> corrections(table.GetSize());
+    std::vector<std::string>* tokenCorrections = nullptr;
+    auto & filter = workerTypos.front();
+    filter.setFoundCallback([&tokenCorrections](const somera::Typo& typo) {
+        *tokenCorrections = typo.corrections;
+    });
+    for (std::size_t token = 0; token < table.GetSize(); ++token) {
+        tokenCorrections = &corrections[token];
+        filter.computeFromSuggestions(
+            tokenTexts[token], std::move(suggestResults[token]), somera::TypoSource{});
+    }
+
+    somera::TypoMan replay(spellChecker);
+    SetupTypoMan(replay);
+    replay.setStatsEnabled(stats != nullptr);
+    replay.setFoundCallback([isLocationShown](const somera::Typo& typo) -> void
+    {
+        showTypoInConsole(typo, isLocationShown);
+    });
+    std::vector<somera::Typo> typos;
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        auto & file = files[i];
+        if (file.isCached) {
+            std::swap(typos, file.cachedTypos);
+        }
+        else {
+            typos.clear();
+            for (auto & occurrence : file.occurrences) {
+                auto & tokenCorrections = corrections[occurrence.token];
+                if (tokenCorrections.empty()) {
+                    continue;
+                }
+                somera::Typo typo;
+                typo.location.filePath = paths[i];
+                typo.location.line = occurrence.line;
+                typo.misspelledWord = table.GetText(occurrence.token);
+                typo.corrections = tokenCorrections;
+                typos.push_back(std::move(typo));
+            }
+            file.occurrences = {};
+            if (file.isCacheable) {
+                resultCache->Insert(file.contentHash, typos);
+            }
+        }
+        for (auto & typo : typos) {
+            replay.replayTypo(typo);
+        }
+        PrintReadError(file.errorCode, paths[i], file.errorPosition);
+    }
+
+    if (stats != nullptr) {
+        for (auto & workerTypo : workerTypos) {
+            *stats += workerTypo.getStats();
+        }
+        *stats += replay.getStats();
+    }
+}
+
+void ScanFilesInParallel(
+    const std::vector<std::string>& paths,
+    const std::vector<std::unique_ptr<FileScanner>>& scanners,
+    somera::TypoManStats* stats)
+{
+    // NOTE:
+    // Each worker has its own scanner, which reports every typo it finds
+    // with the cache disabled. The main thread replays the typo cache in
+    // path order, so the output is the same as scanning the files one by
+    // one.
+    std::vector<std::vector<somera::Typo>> results(paths.size());
+    std::vector<bool> finished(paths.size(), false);
+    std::atomic<std::size_t> nextIndex(0);
+    std::mutex mutex;
+    std::condition_variable finishedCondition;
+
+    auto worker = [&](FileScanner & scanner) {
+        std::vector<somera::Typo> found;
+        for (;;) {
+            const auto index = nextIndex++;
+            if (index >= paths.size()) {
+                break;
+            }
+
+            somera::TextPosition errorPosition;
+            if (auto errorCode = scanner.Scan(paths[index], found, errorPosition)) {
+                PrintReadError(errorCode, paths[index], errorPosition);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            results[index] = std::move(found);
+            found.clear();
+            finished[index] = true;
+            finishedCondition.notify_one();
+        }
+
+        if (stats != nullptr) {
+            std::lock_guard<std::mutex> lock(mutex);
+            *stats += scanner.GetStats();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (auto & scanner : scanners) {
+        threads.emplace_back(worker, std::ref(*scanner));
+    }
+
+    somera::TypoMan replay;
+    SetupTypoMan(replay);
+    replay.setStatsEnabled(stats != nullptr);
+    replay.setFoundCallback([](const somera::Typo& typo) -> void
+    {
+        showTypoInConsole(typo, false);
+    });
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        std::vector<somera::Typo> typos;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            finishedCondition.wait(lock, [&] { return finished[i]; });
+            std::swap(typos, results[i]);
+        }
+        for (auto & typo : typos) {
+            replay.replayTypo(typo);
+        }
+    }
+
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    if (stats != nullptr) {
+        *stats += replay.getStats();
+    }
+}
+
+std::vector<std::string> GetScannedPaths(const CommandLineParser& parser)
+{
+    std::vector<std::string> paths;
+    for (auto & path : parser.getPaths()) {
+        if (!IsIgnoredFile(path)) {
+            paths.push_back(path);
+        }
+    }
+
+    // NOTE: The files are always reported in path order, so the output
+    // doesn't depend on the number of threads.
+    std::sort(std::begin(paths), std::end(paths));
+    return paths;
+}
+
+int RunClient(const CommandLineParser& parser, const std::string& socketPath, int threadCount)
+{
+    if (parser.getValue("-cache")) {
+        std::cerr << "error: -cache cannot be used with -connect, the server keeps its own cache" << std::endl;
+        return 1;
+    }
+    if (parser.getValue("-diff")) {
+        std::cerr << "error: -diff cannot be used with -connect" << std::endl;
+        return 1;
+    }
+    if (parser.exists("-lex-cxx")) {
+        std::cerr << "error: -lex-cxx cannot be used with -connect, pass it to the server" << std::endl;
+        return 1;
+    }
+
+    // NOTE: Each connection is served on its own thread of the server.
+    std::vector<std::unique_ptr<FileScanner>> scanners;
+    for (int i = 0; i < threadCount; ++i) {
+        auto scanner = std::make_unique<RemoteFileScanner>();
+        if (auto errorCode = scanner->Connect(socketPath)) {
+            std::cerr << "error: " << errorCode.message() << ", " << socketPath << std::endl;
+            return 1;
+        }
+        scanners.push_back(std::move(scanner));
+    }
+
+    const bool isStatsEnabled = parser.exists("-stats");
+    somera::TypoManStats stats;
+    ScanFilesInParallel(GetScannedPaths(parser), scanners,
+        isStatsEnabled ? &stats : nullptr);
+    if (isStatsEnabled) {
+        PrintStats(stats, somera::SpellCheckerStats{});
+    }
+    return 0;
+}
+
+int RunServer(
+    const std::shared_ptr<somera::SpellChecker>& spellChecker,
+    const std::string& socketPath,
+    bool isCxxLexed)
+{
+    // NOTE:
+    // Unlike the -cache file, the results stay in memory for the life of
+    // the server, so a file that a client checks again without changes is
+    // only hashed. Every edit of a file adds an entry for its new contents,
+    // so the cache keeps only the most recently used ones.
+    constexpr std::size_t resultCacheCapacity = 4096;
+    auto resultCache = std::make_shared<somera::ScanResultCache>(0);
+    resultCache->SetCapacity(resultCacheCapacity);
+    auto mutex = std::make_shared<std::mutex>();
+    auto checkFile = [spellChecker, resultCache, mutex, isCxxLexed](
+        const std::string& path,
+        std::vector<somera::Typo>& typos,
+        somera::TextPosition& errorPosition) -> std::error_code
+    {
+        somera::ContentHash contentHash;
+        const bool isCacheable = !ComputeScanResultKey(path, isCxxLexed, contentHash);
+        if (isCacheable) {
+            std::lock_guard<std::mutex> lock(*mutex);
+            if (auto cached = resultCache->Find(contentHash)) {
+                typos = *cached;
+                return {};
+            }
+        }
+
+        LocalFileScanner scanner(spellChecker, false, isCxxLexed);
+        auto errorCode = scanner.Scan(path, typos, errorPosition);
+        if (isCacheable && !errorCode) {
+            std::lock_guard<std::mutex> lock(*mutex);
+            resultCache->Insert(contentHash, typos);
+        }
+        return errorCode;
+    };
+
+    somera::TypoServer server(checkFile);
+    if (auto errorCode = server.Listen(socketPath)) {
+        std::cerr << "error: " << errorCode.message() << ", " << socketPath << std::endl;
+        return 1;
+    }
+    if (auto errorCode = server.Run()) {
+        std::cerr << "error: " << errorCode.message() << ", " << socketPath << std::endl;
+        return 1;
+    }
+    return 0;
 }
 
 } // unnamed namespace
@@ -371,48 +818,162 @@ int main(int argc, char *argv[])
         std::cout << "typo-poi version 0.1.0 (July 19, 2016)" << std::endl;
         return 0;
     }
-    if (parser.getPaths().empty()) {
-        std::cerr << "error: no input file" << std::endl;
+    auto engine = somera::SpellCheckerEngine::SignatureHashing;
+    std::string engineName = "signature";
+    if (auto name = parser.getValue("-engine")) {
+        engineName = *name;
+    }
+    if (engineName == "symspell") {
+        engine = somera::SpellCheckerEngine::SymmetricDelete;
+    }
+    else if (engineName == "dawg") {
+        engine = somera::SpellCheckerEngine::Dawg;
+    }
+    else if (engineName != "signature") {
+        std::cerr << "error: unknown engine " << engineName << std::endl;
         return 1;
     }
 
+    int threadCount = 1;
+    if (auto threads = parser.getValue("-j")) {
+        threadCount = std::atoi(threads->c_str());
+        if (threadCount <= 0) {
+            std::cerr << "error: invalid number of threads " << *threads << std::endl;
+            return 1;
+        }
+    }
+
+    if (auto socketPath = parser.getValue("-connect")) {
+        if (parser.getPaths().empty()) {
+            std::cerr << "error: no input file" << std::endl;
+            return 1;
+        }
+        // NOTE: The server has already loaded the dictionaries.
+        return RunClient(parser, *socketPath, threadCount);
+    }
+
     std::vector<std::string> dictionaryPaths = parser.getValues("-dict");
 
-    auto spellChecker = somera::SpellCheckerFactory::Create();
+    if (auto outputPath = parser.getValue("-compile-dict")) {
+        std::vector<std::string> words;
+        for (auto & path : dictionaryPaths) {
+            ReadDictionaryFile(path, [&](const std::string& word) {
+                words.push_back(word);
+            });
+        }
+        if (auto errorCode = somera::CompileDictionary(words, *outputPath)) {
+            std::cerr << "error: " << errorCode.message() << ", " << *outputPath << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // NOTE:
+    // With -diff, the paths are the pathspecs passed to `git diff`, and the
+    // changes are collected before loading the dictionaries so that an
+    // empty patch costs nothing.
+    const auto diffRevision = parser.getValue("-diff");
+    ChangedLines changedLines;
+    std::vector<std::string> changedPaths;
+    if (diffRevision) {
+        if (parser.getValue("-cache")) {
+            std::cerr << "error: -cache cannot be used with -diff" << std::endl;
+            return 1;
+        }
+        std::vector<somera::ChangedFile> changedFiles;
+        if (auto errorCode = somera::GetChangedFiles(*diffRevision, parser.getPaths(), changedFiles)) {
+            std::cerr << "error: " << errorCode.message() << ", git diff " << *diffRevision << std::endl;
+            return 1;
+        }
+        for (auto & file : changedFiles) {
+            if (!IsIgnoredFile(file.path)) {
+                changedPaths.push_back(file.path);
+                changedLines.emplace(file.path, std::move(file.lineRanges));
+            }
+        }
+        if (changedPaths.empty()) {
+            return 0;
+        }
+    }
+
+    const auto serverSocketPath = parser.getValue("-server");
+    if (parser.getPaths().empty() && !serverSocketPath && !diffRevision) {
+        std::cerr << "error: no input file" << std::endl;
+        return 1;
+    }
+
+    // NOTE: A compiled dictionary is mapped as the base dictionary and
+    // the plain text dictionaries are added on top of it.
+    std::shared_ptr<somera::SpellChecker> spellChecker;
+    std::vector<std::string> textDictionaryPaths;
     for (auto & path : dictionaryPaths) {
+        if (!somera::IsCompiledDictionary(path)) {
+            textDictionaryPaths.push_back(path);
+            continue;
+        }
+        if (spellChecker) {
+            std::cerr << "error: only one compiled dictionary can be used, " << path << std::endl;
+            return 1;
+        }
+        if (engine != somera::SpellCheckerEngine::SignatureHashing) {
+            std::cerr << "error: compiled dictionaries require the signature engine, " << path << std::endl;
+            return 1;
+        }
+        std::error_code errorCode;
+        spellChecker = somera::SpellCheckerFactory::CreateFromCompiledDictionary(path, errorCode);
+        if (errorCode) {
+            std::cerr << "error: " << errorCode.message() << ", " << path << std::endl;
+            return 1;
+        }
+    }
+    if (!spellChecker) {
+        spellChecker = somera::SpellCheckerFactory::Create(engine);
+    }
+    std::vector<std::string> words;
+    for (auto & path : textDictionaryPaths) {
         ReadDictionaryFile(path, [&](const std::string& word) {
-            spellChecker->AddWord(word);
+            words.push_back(word);
         });
     }
+    spellChecker->AddWords(words);
 
-    somera::TypoMan typos;
-    typos.setSpellChecker(spellChecker);
-    typos.setStrictWhiteSpace(false);
-    typos.setStrictHyphen(false);
-    typos.setMinimumWordSize(3);
-    typos.setMaxCorrectWordCount(4);
-    typos.setCacheEnabled(true);
-    typos.setCacheSize(100);
-    typos.setFoundCallback([](const somera::Typo& typo) -> void
-    {
-        showTypoInConsole(typo);
-    });
+    const bool isCxxLexed = parser.exists("-lex-cxx");
+    if (serverSocketPath) {
+        return RunServer(spellChecker, *serverSocketPath, isCxxLexed);
+    }
 
-    for (auto & path : parser.getPaths()) {
-        auto ext = std::get<1>(somera::FileSystem::splitExtension(path));
-        if (ext == ".png"
-            || ext == ".jpg"
-            || ext == "exe"
-            || ext == ".DS_Store"
-            || ext == ".o"
-            || ext == ".a"
-            || ext == ".d"
-            || ext == ".lib"
-            || ext == ".dll") {
-            continue;
-        }
-        ReadTextFileWithoutPedanticMode(typos, path);
+    const bool isStatsEnabled = parser.exists("-stats");
+    spellChecker->SetStatsEnabled(isStatsEnabled);
+
+    const auto cachePath = parser.getValue("-cache");
+    std::unique_ptr<somera::ScanResultCache> resultCache;
+    if (cachePath) {
+        // NOTE: A missing or broken cache file just means a full scan.
+        resultCache = std::make_unique<somera::ScanResultCache>(
+            ComputeDictionaryFingerprint(engineName, dictionaryPaths));
+        resultCache->Load(*cachePath);
     }
 
+    // NOTE: With -diff, a typo is shown with the line of its first occurrence.
+    somera::TypoManStats stats;
+    ScanFilesByUniqueWords(
+        diffRevision ? changedPaths : GetScannedPaths(parser),
+        spellChecker,
+        threadCount,
+        diffRevision ? &changedLines : nullptr,
+        isCxxLexed,
+        resultCache.get(),
+        isStatsEnabled ? &stats : nullptr,
+        static_cast<bool>(diffRevision));
+    if (isStatsEnabled) {
+        PrintStats(stats, spellChecker->GetStats());
+    }
+
+    if (resultCache) {
+        if (auto errorCode = resultCache->Save(*cachePath)) {
+            std::cerr << "error: " << errorCode.message() << ", " << *cachePath << std::endl;
+            return 1;
+        }
+    }
     return 0;
 }
@@ -0,0 +1,98 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#include "SpellChecker.h"
+#include <gtest/iutest_switch.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace somera;
+
+namespace {
+
+const char* const imagePath = "CompiledDictionaryTest.dict";
+
+std::vector<char> CompileImage()
+{
+    const std::vector<std::string> words = {"hello", "world", "Polish", "polish", "typo"};
+    EXPECT_FALSE(CompileDictionary(words, imagePath));
+    std::ifstream stream(imagePath, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+std::error_code OpenImage(const std::vector<char>& image)
+{
+    {
+        std::ofstream stream(imagePath, std::ios::binary);
+        stream.write(image.data(), image.size());
+    }
+    std::error_code errorCode;
+    SpellCheckerFactory::OpenDictionary(imagePath, errorCode);
+    std::remove(imagePath);
+    return errorCode;
+}
+
+uint32_t ReadUInt32(const std::vector<char>& image, std::size_t offset)
+{
+    uint32_t value;
+    std::memcpy(&value, image.data() + offset, sizeof(value));
+    return value;
+}
+
+void WriteUInt32(std::vector<char>& image, std::size_t offset, uint32_t value)
+{
+    std::memcpy(image.data() + offset, &value, sizeof(value));
+}
+
+// NOTE: See the layout of the image in SpellChecker.cpp.
+std::size_t GetBucketsOffset(const std::vector<char>& image)
+{
+    const auto wordCount = ReadUInt32(image, 16);
+    const auto slotCount = ReadUInt32(image, 20);
+    return 32 + 8 * wordCount + 16 * slotCount;
+}
+
+std::size_t GetWordOffsetsOffset(const std::vector<char>& image)
+{
+    const auto bucketCount = ReadUInt32(image, 12);
+    return GetBucketsOffset(image) + 12 * bucketCount;
+}
+
+} // unnamed namespace
+
+TEST(CompiledDictionary, OpensCompiledImage)
+{
+    auto image = CompileImage();
+    EXPECT_FALSE(OpenImage(image));
+}
+
+TEST(CompiledDictionary, RejectsBucketOutOfRange)
+{
+    auto image = CompileImage();
+    WriteUInt32(image, GetBucketsOffset(image) + 4, 0x7fffffff);
+    EXPECT_EQ(std::make_error_code(std::errc::invalid_argument), OpenImage(image));
+}
+
+TEST(CompiledDictionary, RejectsWordOffsetsOutOfOrder)
+{
+    auto image = CompileImage();
+    const auto offset = GetWordOffsetsOffset(image);
+    WriteUInt32(image, offset + 4, ReadUInt32(image, offset + 8) + 1);
+    EXPECT_EQ(std::make_error_code(std::errc::invalid_argument), OpenImage(image));
+}
+
+TEST(CompiledDictionary, RejectsExactWordOutOfRange)
+{
+    auto image = CompileImage();
+    const auto slotCount = ReadUInt32(image, 20);
+    const auto slotsOffset = 32 + 8 * ReadUInt32(image, 16);
+    for (uint32_t i = 0; i < slotCount; ++i) {
+        const auto positionOffset = slotsOffset + 16 * i + 8;
+        if (ReadUInt32(image, positionOffset) != 0xffffffff) {
+            WriteUInt32(image, positionOffset, 0x7fffffff);
+            break;
+        }
+    }
+    EXPECT_EQ(std::make_error_code(std::errc::invalid_argument), OpenImage(image));
+}
@@ -0,0 +1,20 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#include "EditDistance.h"
+#include <gtest/iutest_switch.hpp>
+
+using namespace somera;
+
+TEST(ClosestMatchFuzzySimilarity_Boer, MatchesUTF8Characters)
+{
+    EXPECT_EQ(1.0, closestMatchFuzzySimilarity_Boer("caf\xC3\xA9", "caf\xC3\xA9"));
+    EXPECT_EQ(0.75, closestMatchFuzzySimilarity_Boer("caf\xC3\xA9", "cafx"));
+}
+
+TEST(ClosestMatchFuzzySimilarity_Boer, InvalidUTF8MatchesAsEmpty)
+{
+    // NOTE: A lone continuation byte or a truncated sequence is not UTF-8.
+    EXPECT_EQ(0.0, closestMatchFuzzySimilarity_Boer("caf\xA9", "caf\xC3\xA9"));
+    EXPECT_EQ(0.0, closestMatchFuzzySimilarity_Boer("caf\xC3", "cafe"));
+    EXPECT_EQ(1.0, closestMatchFuzzySimilarity_Boer("caf\xC3", "caf\xA9"));
+}
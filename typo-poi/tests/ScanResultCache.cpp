@@ -0,0 +1,79 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#include "ScanResultCache.h"
+#include <gtest/iutest_switch.hpp>
+
+using namespace somera;
+
+namespace {
+
+ContentHash MakeContentHash(uint64_t hash)
+{
+    ContentHash contentHash;
+    contentHash.hash = hash;
+    contentHash.size = hash * 10;
+    return contentHash;
+}
+
+std::vector<Typo> MakeTypos(const std::string& word)
+{
+    Typo typo;
+    typo.misspelledWord = word;
+    return {typo};
+}
+
+} // unnamed namespace
+
+TEST(ScanResultCache, FindsInsertedContent)
+{
+    ScanResultCache cache(0);
+    EXPECT_EQ(nullptr, cache.Find(MakeContentHash(1)));
+    cache.Insert(MakeContentHash(1), MakeTypos("recieve"));
+    auto typos = cache.Find(MakeContentHash(1));
+    ASSERT_NE(nullptr, typos);
+    EXPECT_EQ("recieve", typos->front().misspelledWord);
+
+    auto otherSize = MakeContentHash(1);
+    otherSize.size += 1;
+    EXPECT_EQ(nullptr, cache.Find(otherSize));
+}
+
+TEST(ScanResultCache, EvictsLeastRecentlyUsed)
+{
+    ScanResultCache cache(0);
+    cache.SetCapacity(3);
+    cache.Insert(MakeContentHash(1), MakeTypos("a"));
+    cache.Insert(MakeContentHash(2), MakeTypos("b"));
+    cache.Insert(MakeContentHash(3), MakeTypos("c"));
+    EXPECT_NE(nullptr, cache.Find(MakeContentHash(1)));
+
+    cache.Insert(MakeContentHash(4), MakeTypos("d"));
+    EXPECT_EQ(3, cache.GetSize());
+    EXPECT_EQ(nullptr, cache.Find(MakeContentHash(2)));
+    EXPECT_NE(nullptr, cache.Find(MakeContentHash(1)));
+    EXPECT_NE(nullptr, cache.Find(MakeContentHash(3)));
+    EXPECT_NE(nullptr, cache.Find(MakeContentHash(4)));
+}
+
+TEST(ScanResultCache, ReinsertingDoesNotGrow)
+{
+    ScanResultCache cache(0);
+    cache.SetCapacity(2);
+    for (int i = 0; i < 10; ++i) {
+        cache.Insert(MakeContentHash(1), MakeTypos("a"));
+    }
+    EXPECT_EQ(1, cache.GetSize());
+}
+
+TEST(ScanResultCache, UnboundedByDefault)
+{
+    ScanResultCache cache(0);
+    for (uint64_t i = 1; i <= 10000; ++i) {
+        cache.Insert(MakeContentHash(i), {});
+    }
+    EXPECT_EQ(10000, cache.GetSize());
+    cache.SetCapacity(100);
+    EXPECT_EQ(100, cache.GetSize());
+    EXPECT_NE(nullptr, cache.Find(MakeContentHash(10000)));
+    EXPECT_EQ(nullptr, cache.Find(MakeContentHash(1)));
+}
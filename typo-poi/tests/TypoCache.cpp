@@ -0,0 +1,82 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#include "Typo.h"
+#include <gtest/iutest_switch.hpp>
+
+using namespace somera;
+
+namespace {
+
+Typo MakeTypo(const std::string& word)
+{
+    Typo typo;
+    typo.misspelledWord = word;
+    return typo;
+}
+
+} // unnamed namespace
+
+TEST(TypoCache, TrivialCase)
+{
+    TypoCache cache;
+    EXPECT_FALSE(cache.exists("recieve"));
+    cache.insert(MakeTypo("recieve"));
+    EXPECT_TRUE(cache.exists("recieve"));
+    EXPECT_EQ(1, cache.getHitCount());
+    EXPECT_EQ(1, cache.getMissCount());
+}
+
+TEST(TypoCache, EvictsLeastFrequentlyUsed)
+{
+    TypoCache cache;
+    cache.setCapacity(10);
+    for (int i = 0; i < 10; ++i) {
+        cache.insert(MakeTypo("word" + std::to_string(i)));
+    }
+    for (int i = 1; i < 10; ++i) {
+        EXPECT_TRUE(cache.exists("word" + std::to_string(i)));
+    }
+    cache.insert(MakeTypo("endl"));
+    EXPECT_FALSE(cache.exists("word0"));
+    EXPECT_TRUE(cache.exists("endl"));
+}
+
+TEST(TypoCache, NewWordIsNotEvictedByNextNewWord)
+{
+    TypoCache cache;
+    cache.setCapacity(10);
+    for (int i = 0; i < 10; ++i) {
+        cache.insert(MakeTypo("word" + std::to_string(i)));
+    }
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(cache.exists("word" + std::to_string(i)));
+    }
+
+    // NOTE: Each new word evicts one of the words that were hit once.
+    cache.insert(MakeTypo("endl"));
+    cache.insert(MakeTypo("cerr"));
+    EXPECT_TRUE(cache.exists("endl"));
+    EXPECT_TRUE(cache.exists("cerr"));
+
+    int remaining = 0;
+    for (int i = 0; i < 10; ++i) {
+        if (cache.exists("word" + std::to_string(i))) {
+            ++remaining;
+        }
+    }
+    EXPECT_EQ(8, remaining);
+}
+
+TEST(TypoCache, FrequentWordsOutliveNewWords)
+{
+    TypoCache cache;
+    cache.setCapacity(10);
+    cache.insert(MakeTypo("teh"));
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(cache.exists("teh"));
+    }
+    for (int i = 0; i < 20; ++i) {
+        cache.insert(MakeTypo("word" + std::to_string(i)));
+    }
+    EXPECT_TRUE(cache.exists("teh"));
+}
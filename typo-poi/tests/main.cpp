@@ -0,0 +1,9 @@
+// Copyright (c) 2016 mogemimi. Distributed under the MIT license.
+
+#include <iutest.hpp>
+
+int main(int argc, char *argv[])
+{
+    IUTEST_INIT(&argc, argv);
+    return IUTEST_RUN_ALL_TESTS();
+}